@@ -26,7 +26,7 @@ typedef struct _Gst_Egueb_Record_Encoder
 
 Gst_Egueb_Record_Encoder encoders[] = {
 	{ ENCODER_TYPE_IMAGE, "png", "ffmpegcolorspace ! pngenc snapshot=true ! filesink location=%s.png" },
-	{ ENCODER_TYPE_VIDEO, "theora", "ffmpegcolorspace ! theoraenc ! oggmux ! filesink location=%s.ogg" },
+	{ ENCODER_TYPE_VIDEO, "theora", "theoraenc ! oggmux ! filesink location=%s.ogg" },
 };
 
 static void pipeline_eos_cb(GstBus *bus, GstMessage *msg, gpointer *data)
@@ -4,6 +4,15 @@ plugin_LTLIBRARIES = src/modules/libgstegueb.la
 src_modules_libgstegueb_la_SOURCES = \
 src/modules/gst_egueb_xml_sink.c \
 src/modules/gst_egueb_src.c \
+src/modules/gst_egueb_converter.c \
+src/modules/gst_egueb_damages.c \
+src/modules/gst_egueb_pool.c \
+src/modules/gst_egueb_coverage.c \
+src/modules/gst_egueb_cache.c \
+src/modules/gst_egueb_store.c \
+src/modules/gst_egueb_qos.c \
+src/modules/gst_egueb_latency.c \
+src/modules/gst_egueb_navigation.c \
 src/modules/gst_egueb_demux.c \
 src/modules/gst_egueb_document.c \
 src/modules/gst_egueb.c
@@ -0,0 +1,118 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gst/gst.h>
+
+#include "gst_egueb_cache.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_egueb_src_debug);
+#define GST_CAT_DEFAULT gst_egueb_src_debug
+
+/* The frames of one period of a looping document, indexed by their number
+ * inside the period. The frames are kept until the cache is flushed, once
+ * the maximum is reached the rest of the period is rendered as usual, there
+ * is no point on evicting frames that will be needed again on the next
+ * period
+ */
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+struct _Gst_Egueb_Cache
+{
+	GMutex *lock;
+	GHashTable *frames;
+	guint64 size;
+	guint64 max;
+};
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+Gst_Egueb_Cache * gst_egueb_cache_new(void)
+{
+	Gst_Egueb_Cache *thiz;
+
+	thiz = g_new0(Gst_Egueb_Cache, 1);
+	thiz->lock = g_mutex_new();
+	thiz->frames = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, (GDestroyNotify)gst_buffer_unref);
+
+	return thiz;
+}
+
+void gst_egueb_cache_free(Gst_Egueb_Cache *thiz)
+{
+	g_hash_table_destroy(thiz->frames);
+	g_mutex_free(thiz->lock);
+	g_free(thiz);
+}
+
+void gst_egueb_cache_max_set(Gst_Egueb_Cache *thiz, guint64 max)
+{
+	g_mutex_lock(thiz->lock);
+	thiz->max = max;
+	/* the frames can not be partially dropped */
+	if (thiz->size > max)
+	{
+		g_hash_table_remove_all(thiz->frames);
+		thiz->size = 0;
+	}
+	g_mutex_unlock(thiz->lock);
+}
+
+void gst_egueb_cache_flush(Gst_Egueb_Cache *thiz)
+{
+	g_mutex_lock(thiz->lock);
+	if (thiz->size)
+		GST_DEBUG("Flushing %" G_GUINT64_FORMAT " bytes of frames",
+				thiz->size);
+	g_hash_table_remove_all(thiz->frames);
+	thiz->size = 0;
+	g_mutex_unlock(thiz->lock);
+}
+
+GstBuffer * gst_egueb_cache_get(Gst_Egueb_Cache *thiz, guint frame)
+{
+	GstBuffer *buffer;
+
+	g_mutex_lock(thiz->lock);
+	buffer = g_hash_table_lookup(thiz->frames, GUINT_TO_POINTER(frame));
+	if (buffer)
+		gst_buffer_ref(buffer);
+	g_mutex_unlock(thiz->lock);
+
+	return buffer;
+}
+
+gboolean gst_egueb_cache_add(Gst_Egueb_Cache *thiz, guint frame,
+		GstBuffer *buffer)
+{
+	gboolean ret = FALSE;
+
+	g_mutex_lock(thiz->lock);
+	if (thiz->size + GST_BUFFER_SIZE(buffer) <= thiz->max &&
+			!g_hash_table_lookup(thiz->frames, GUINT_TO_POINTER(frame)))
+	{
+		g_hash_table_insert(thiz->frames, GUINT_TO_POINTER(frame),
+				gst_buffer_ref(buffer));
+		thiz->size += GST_BUFFER_SIZE(buffer);
+		ret = TRUE;
+	}
+	g_mutex_unlock(thiz->lock);
+
+	return ret;
+}
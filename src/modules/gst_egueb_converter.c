@@ -0,0 +1,746 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <Enesim.h>
+
+#include "gst_egueb_converter.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define GST_EGUEB_CONVERTER_X86 1
+#include <immintrin.h>
+#endif
+
+/* The surface is always premultiplied ARGB8888 (native endian). The xRGB
+ * output has the same layout, so converting is a matter of copying the
+ * pixels and forcing the padding byte. The ARGB output is either a copy
+ * when premultiplied or, with straight alpha, every color component is
+ * divided by the alpha.
+ *
+ * The YUV outputs use the BT.601 matrix in the limited range, the chroma is
+ * the average of the pixels it covers. Like the xRGB output the alpha is
+ * ignored.
+ *
+ * Every kernel must give the same result as the C one. The SIMD versions
+ * of the un-premultiply do the division in single precision floats, which
+ * is exact here as the numerator never has more than 16 bits
+ */
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+typedef void (*Gst_Egueb_Converter_Row)(guint32 *dst, const guint32 *src,
+		gint len);
+/* the luma of every pixel of a row */
+typedef void (*Gst_Egueb_Converter_Luma)(guint8 *y, const guint32 *src,
+		gint len);
+/* the chroma of every pair of pixels of two rows */
+typedef void (*Gst_Egueb_Converter_Chroma)(guint8 *u, guint8 *v,
+		const guint32 *s0, const guint32 *s1, gint len);
+
+typedef struct _Gst_Egueb_Converter_Kernels
+{
+	const gchar *name;
+	Gst_Egueb_Converter_Row xrgb;
+	Gst_Egueb_Converter_Row argb;
+	Gst_Egueb_Converter_Luma luma;
+	Gst_Egueb_Converter_Chroma chroma;
+} Gst_Egueb_Converter_Kernels;
+
+static inline guint32 _gst_egueb_converter_unpremul(guint32 p)
+{
+	guint32 a = p >> 24;
+	guint32 r, g, b;
+
+	if (!a)
+		return 0;
+	r = (((p >> 16) & 0xff) * 255 + (a >> 1)) / a;
+	g = (((p >> 8) & 0xff) * 255 + (a >> 1)) / a;
+	b = ((p & 0xff) * 255 + (a >> 1)) / a;
+
+	return (a << 24) | (MIN(r, 255) << 16) | (MIN(g, 255) << 8) |
+			MIN(b, 255);
+}
+
+static void _gst_egueb_converter_argb8888_copy(guint32 *dst,
+		const guint32 *src, gint len)
+{
+	memcpy(dst, src, len * 4);
+}
+
+static void _gst_egueb_converter_argb8888_xrgb8888(guint32 *dst,
+		const guint32 *src, gint len)
+{
+	while (len--)
+		*dst++ = *src++ | 0xff000000;
+}
+
+static void _gst_egueb_converter_argb8888_argb8888(guint32 *dst,
+		const guint32 *src, gint len)
+{
+	while (len--)
+		*dst++ = _gst_egueb_converter_unpremul(*src++);
+}
+
+static void _gst_egueb_converter_argb8888_luma(guint8 *y, const guint32 *src,
+		gint len)
+{
+	while (len--)
+	{
+		guint32 p = *src++;
+		gint r = (p >> 16) & 0xff;
+		gint g = (p >> 8) & 0xff;
+		gint b = p & 0xff;
+
+		*y++ = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+	}
+}
+
+static void _gst_egueb_converter_argb8888_chroma(guint8 *u, guint8 *v,
+		const guint32 *s0, const guint32 *s1, gint len)
+{
+	gint i;
+
+	for (i = 0; i < len; i += 2)
+	{
+		guint32 p[4];
+		gint r = 2, g = 2, b = 2;
+		gint j;
+
+		/* the last column of an odd width is repeated */
+		p[0] = s0[i];
+		p[1] = i + 1 < len ? s0[i + 1] : s0[i];
+		p[2] = s1[i];
+		p[3] = i + 1 < len ? s1[i + 1] : s1[i];
+		for (j = 0; j < 4; j++)
+		{
+			r += (p[j] >> 16) & 0xff;
+			g += (p[j] >> 8) & 0xff;
+			b += p[j] & 0xff;
+		}
+		r >>= 2;
+		g >>= 2;
+		b >>= 2;
+
+		*u++ = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+		*v++ = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+	}
+}
+
+#ifdef GST_EGUEB_CONVERTER_X86
+__attribute__((target("sse2")))
+static void _gst_egueb_converter_argb8888_xrgb8888_sse2(guint32 *dst,
+		const guint32 *src, gint len)
+{
+	const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+	for (; len >= 4; len -= 4, src += 4, dst += 4)
+	{
+		__m128i px;
+
+		px = _mm_loadu_si128((const __m128i *)src);
+		_mm_storeu_si128((__m128i *)dst, _mm_or_si128(px, alpha));
+	}
+	_gst_egueb_converter_argb8888_xrgb8888(dst, src, len);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i _gst_egueb_converter_div_sse2(__m128i c, __m128i half,
+		__m128 af)
+{
+	const __m128i max = _mm_set1_epi32(255);
+	__m128i n, q, over;
+
+	/* (c * 255 + a / 2) / a, clamped */
+	n = _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(c, 8), c), half);
+	q = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(n), af));
+	over = _mm_cmpgt_epi32(q, max);
+	return _mm_or_si128(_mm_andnot_si128(over, q), _mm_and_si128(over, max));
+}
+
+__attribute__((target("sse2")))
+static void _gst_egueb_converter_argb8888_argb8888_sse2(guint32 *dst,
+		const guint32 *src, gint len)
+{
+	const __m128i mask = _mm_set1_epi32(0xff);
+
+	for (; len >= 4; len -= 4, src += 4, dst += 4)
+	{
+		__m128i px, a, half, r, g, b, out;
+		__m128 af;
+
+		px = _mm_loadu_si128((const __m128i *)src);
+		a = _mm_srli_epi32(px, 24);
+		half = _mm_srli_epi32(a, 1);
+		af = _mm_cvtepi32_ps(a);
+
+		r = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+		g = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+		b = _mm_and_si128(px, mask);
+		r = _gst_egueb_converter_div_sse2(r, half, af);
+		g = _gst_egueb_converter_div_sse2(g, half, af);
+		b = _gst_egueb_converter_div_sse2(b, half, af);
+
+		out = _mm_or_si128(_mm_slli_epi32(a, 24), _mm_slli_epi32(r, 16));
+		out = _mm_or_si128(out, _mm_or_si128(_mm_slli_epi32(g, 8), b));
+		/* fully transparent pixels are all zero */
+		out = _mm_andnot_si128(_mm_cmpeq_epi32(a, _mm_setzero_si128()),
+				out);
+		_mm_storeu_si128((__m128i *)dst, out);
+	}
+	_gst_egueb_converter_argb8888_argb8888(dst, src, len);
+}
+
+/* the sums of the BGRA words of each pixel, on the lanes 0 and 2 */
+__attribute__((target("sse2")))
+static inline __m128i _gst_egueb_converter_madd_sse2(__m128i px16,
+		__m128i coeffs)
+{
+	__m128i m;
+
+	m = _mm_madd_epi16(px16, coeffs);
+	m = _mm_add_epi32(m, _mm_srli_epi64(m, 32));
+	return _mm_shuffle_epi32(m, _MM_SHUFFLE(3, 3, 2, 0));
+}
+
+__attribute__((target("sse2")))
+static void _gst_egueb_converter_argb8888_luma_sse2(guint8 *y,
+		const guint32 *src, gint len)
+{
+	const __m128i coeffs = _mm_setr_epi16(25, 129, 66, 0, 25, 129, 66, 0);
+	const __m128i round = _mm_set1_epi32(128);
+	const __m128i offset = _mm_set1_epi32(16);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; len >= 8; len -= 8, src += 8, y += 8)
+	{
+		__m128i l[2];
+		gint i;
+
+		for (i = 0; i < 2; i++)
+		{
+			__m128i px, lo, hi;
+
+			px = _mm_loadu_si128((const __m128i *)(src + i * 4));
+			lo = _gst_egueb_converter_madd_sse2(
+					_mm_unpacklo_epi8(px, zero), coeffs);
+			hi = _gst_egueb_converter_madd_sse2(
+					_mm_unpackhi_epi8(px, zero), coeffs);
+			l[i] = _mm_unpacklo_epi64(lo, hi);
+			l[i] = _mm_add_epi32(_mm_srli_epi32(
+					_mm_add_epi32(l[i], round), 8), offset);
+		}
+		l[0] = _mm_packs_epi32(l[0], l[1]);
+		_mm_storel_epi64((__m128i *)y, _mm_packus_epi16(l[0], l[0]));
+	}
+	_gst_egueb_converter_argb8888_luma(y, src, len);
+}
+
+__attribute__((target("sse2")))
+static void _gst_egueb_converter_argb8888_chroma_sse2(guint8 *u, guint8 *v,
+		const guint32 *s0, const guint32 *s1, gint len)
+{
+	const __m128i ucoeffs = _mm_setr_epi16(112, -74, -38, 0,
+			112, -74, -38, 0);
+	const __m128i vcoeffs = _mm_setr_epi16(-18, -94, 112, 0,
+			-18, -94, 112, 0);
+	const __m128i round = _mm_set1_epi32(128);
+	const __m128i two = _mm_set1_epi16(2);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; len >= 8; len -= 8, s0 += 8, s1 += 8, u += 4, v += 4)
+	{
+		__m128i cu[2], cv[2];
+		guint32 out;
+		gint i;
+
+		for (i = 0; i < 2; i++)
+		{
+			__m128i a, b, lo, hi, avg;
+
+			a = _mm_loadu_si128((const __m128i *)(s0 + i * 4));
+			b = _mm_loadu_si128((const __m128i *)(s1 + i * 4));
+			/* add both rows and then both columns */
+			lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+					_mm_unpacklo_epi8(b, zero));
+			hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+					_mm_unpackhi_epi8(b, zero));
+			lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+			hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+			avg = _mm_srli_epi16(_mm_add_epi16(
+					_mm_unpacklo_epi64(lo, hi), two), 2);
+
+			cu[i] = _gst_egueb_converter_madd_sse2(avg, ucoeffs);
+			cv[i] = _gst_egueb_converter_madd_sse2(avg, vcoeffs);
+		}
+		cu[0] = _mm_unpacklo_epi64(cu[0], cu[1]);
+		cv[0] = _mm_unpacklo_epi64(cv[0], cv[1]);
+		cu[0] = _mm_add_epi32(_mm_srai_epi32(
+				_mm_add_epi32(cu[0], round), 8), round);
+		cv[0] = _mm_add_epi32(_mm_srai_epi32(
+				_mm_add_epi32(cv[0], round), 8), round);
+		cu[0] = _mm_packs_epi32(cu[0], cv[0]);
+		cu[0] = _mm_packus_epi16(cu[0], cu[0]);
+
+		out = _mm_cvtsi128_si32(cu[0]);
+		memcpy(u, &out, 4);
+		out = _mm_cvtsi128_si32(_mm_srli_si128(cu[0], 4));
+		memcpy(v, &out, 4);
+	}
+	_gst_egueb_converter_argb8888_chroma(u, v, s0, s1, len);
+}
+
+__attribute__((target("ssse3")))
+static void _gst_egueb_converter_argb8888_argb8888_ssse3(guint32 *dst,
+		const guint32 *src, gint len)
+{
+	/* pick one byte of every pixel into the low byte of its lane */
+	const __m128i sr = _mm_setr_epi8(2, -1, -1, -1, 6, -1, -1, -1,
+			10, -1, -1, -1, 14, -1, -1, -1);
+	const __m128i sg = _mm_setr_epi8(1, -1, -1, -1, 5, -1, -1, -1,
+			9, -1, -1, -1, 13, -1, -1, -1);
+	const __m128i sb = _mm_setr_epi8(0, -1, -1, -1, 4, -1, -1, -1,
+			8, -1, -1, -1, 12, -1, -1, -1);
+	/* and put them back */
+	const __m128i dr = _mm_setr_epi8(-1, -1, 0, -1, -1, -1, 4, -1,
+			-1, -1, 8, -1, -1, -1, 12, -1);
+	const __m128i dg = _mm_setr_epi8(-1, 0, -1, -1, -1, 4, -1, -1,
+			-1, 8, -1, -1, -1, 12, -1, -1);
+	const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+	for (; len >= 4; len -= 4, src += 4, dst += 4)
+	{
+		__m128i px, a, half, r, g, b, out;
+		__m128 af;
+
+		px = _mm_loadu_si128((const __m128i *)src);
+		a = _mm_srli_epi32(px, 24);
+		half = _mm_srli_epi32(a, 1);
+		af = _mm_cvtepi32_ps(a);
+
+		r = _gst_egueb_converter_div_sse2(_mm_shuffle_epi8(px, sr),
+				half, af);
+		g = _gst_egueb_converter_div_sse2(_mm_shuffle_epi8(px, sg),
+				half, af);
+		b = _gst_egueb_converter_div_sse2(_mm_shuffle_epi8(px, sb),
+				half, af);
+
+		out = _mm_or_si128(_mm_and_si128(px, alpha),
+				_mm_shuffle_epi8(r, dr));
+		out = _mm_or_si128(out, _mm_or_si128(_mm_shuffle_epi8(g, dg), b));
+		out = _mm_andnot_si128(_mm_cmpeq_epi32(a, _mm_setzero_si128()),
+				out);
+		_mm_storeu_si128((__m128i *)dst, out);
+	}
+	_gst_egueb_converter_argb8888_argb8888(dst, src, len);
+}
+
+__attribute__((target("avx2")))
+static void _gst_egueb_converter_argb8888_xrgb8888_avx2(guint32 *dst,
+		const guint32 *src, gint len)
+{
+	const __m256i alpha = _mm256_set1_epi32(0xff000000);
+
+	for (; len >= 8; len -= 8, src += 8, dst += 8)
+	{
+		__m256i px;
+
+		px = _mm256_loadu_si256((const __m256i *)src);
+		_mm256_storeu_si256((__m256i *)dst, _mm256_or_si256(px, alpha));
+	}
+	_gst_egueb_converter_argb8888_xrgb8888(dst, src, len);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i _gst_egueb_converter_div_avx2(__m256i c, __m256i half,
+		__m256 af)
+{
+	__m256i n, q;
+
+	n = _mm256_add_epi32(_mm256_sub_epi32(_mm256_slli_epi32(c, 8), c), half);
+	q = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(n), af));
+	return _mm256_min_epi32(q, _mm256_set1_epi32(255));
+}
+
+__attribute__((target("avx2")))
+static void _gst_egueb_converter_argb8888_argb8888_avx2(guint32 *dst,
+		const guint32 *src, gint len)
+{
+	const __m256i mask = _mm256_set1_epi32(0xff);
+
+	for (; len >= 8; len -= 8, src += 8, dst += 8)
+	{
+		__m256i px, a, half, r, g, b, out, zero;
+		__m256 af;
+
+		px = _mm256_loadu_si256((const __m256i *)src);
+		a = _mm256_srli_epi32(px, 24);
+		half = _mm256_srli_epi32(a, 1);
+		af = _mm256_cvtepi32_ps(a);
+
+		r = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+		g = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+		b = _mm256_and_si256(px, mask);
+		r = _gst_egueb_converter_div_avx2(r, half, af);
+		g = _gst_egueb_converter_div_avx2(g, half, af);
+		b = _gst_egueb_converter_div_avx2(b, half, af);
+
+		/* the division by zero gives a negative value, min keeps it */
+		out = _mm256_or_si256(_mm256_slli_epi32(a, 24),
+				_mm256_slli_epi32(r, 16));
+		out = _mm256_or_si256(out, _mm256_or_si256(
+				_mm256_slli_epi32(g, 8), b));
+		zero = _mm256_cmpeq_epi32(a, _mm256_setzero_si256());
+		out = _mm256_andnot_si256(zero, out);
+		_mm256_storeu_si256((__m256i *)dst, out);
+	}
+	_gst_egueb_converter_argb8888_argb8888(dst, src, len);
+}
+#endif
+
+static const Gst_Egueb_Converter_Kernels _kernels_c = {
+	"c",
+	_gst_egueb_converter_argb8888_xrgb8888,
+	_gst_egueb_converter_argb8888_argb8888,
+	_gst_egueb_converter_argb8888_luma,
+	_gst_egueb_converter_argb8888_chroma,
+};
+
+#ifdef GST_EGUEB_CONVERTER_X86
+static const Gst_Egueb_Converter_Kernels _kernels_sse2 = {
+	"sse2",
+	_gst_egueb_converter_argb8888_xrgb8888_sse2,
+	_gst_egueb_converter_argb8888_argb8888_sse2,
+	_gst_egueb_converter_argb8888_luma_sse2,
+	_gst_egueb_converter_argb8888_chroma_sse2,
+};
+
+static const Gst_Egueb_Converter_Kernels _kernels_ssse3 = {
+	"ssse3",
+	_gst_egueb_converter_argb8888_xrgb8888_sse2,
+	_gst_egueb_converter_argb8888_argb8888_ssse3,
+	_gst_egueb_converter_argb8888_luma_sse2,
+	_gst_egueb_converter_argb8888_chroma_sse2,
+};
+
+static const Gst_Egueb_Converter_Kernels _kernels_avx2 = {
+	"avx2",
+	_gst_egueb_converter_argb8888_xrgb8888_avx2,
+	_gst_egueb_converter_argb8888_argb8888_avx2,
+	_gst_egueb_converter_argb8888_luma_sse2,
+	_gst_egueb_converter_argb8888_chroma_sse2,
+};
+#endif
+
+/* from the best to the worst */
+static const Gst_Egueb_Converter_Kernels *_kernels[] = {
+#ifdef GST_EGUEB_CONVERTER_X86
+	&_kernels_avx2,
+	&_kernels_ssse3,
+	&_kernels_sse2,
+#endif
+	&_kernels_c,
+	NULL,
+};
+
+/* the kernels forced by gst_egueb_converter_kernels_set() */
+static const Gst_Egueb_Converter_Kernels *_kernels_forced = NULL;
+
+static gboolean _gst_egueb_converter_kernels_runnable(
+		const Gst_Egueb_Converter_Kernels *k)
+{
+#ifdef GST_EGUEB_CONVERTER_X86
+	__builtin_cpu_init();
+	if (k == &_kernels_avx2)
+		return __builtin_cpu_supports("avx2");
+	if (k == &_kernels_ssse3)
+		return __builtin_cpu_supports("ssse3");
+	if (k == &_kernels_sse2)
+		return __builtin_cpu_supports("sse2");
+#endif
+	return TRUE;
+}
+
+static gpointer _gst_egueb_converter_kernels_choose(gpointer data)
+{
+	gint i;
+
+	/* in case something is wrong with the SIMD kernels they can be
+	 * disabled at runtime
+	 */
+	if (g_getenv("GST_EGUEB_CONVERTER_NO_SIMD"))
+		return (gpointer)&_kernels_c;
+	for (i = 0; _kernels[i]; i++)
+	{
+		if (_gst_egueb_converter_kernels_runnable(_kernels[i]))
+			break;
+	}
+	return (gpointer)_kernels[i];
+}
+
+static const Gst_Egueb_Converter_Kernels * _gst_egueb_converter_kernels_get(void)
+{
+	static GOnce once = G_ONCE_INIT;
+
+	if (_kernels_forced)
+		return _kernels_forced;
+	g_once(&once, _gst_egueb_converter_kernels_choose, NULL);
+	return once.retval;
+}
+
+static void _gst_egueb_converter_rgb(Gst_Egueb_Converter_Row row,
+		guint8 *sdata, size_t sstride, guint8 *data, gint w,
+		Eina_Rectangle *clip)
+{
+	gint stride;
+	gint y;
+
+	stride = gst_video_format_get_row_stride(GST_VIDEO_FORMAT_BGRx, 0, w);
+	data += (clip->y * stride) + (clip->x * 4);
+	for (y = 0; y < clip->h; y++)
+	{
+		row((guint32 *)data, (const guint32 *)sdata, clip->w);
+		sdata += sstride;
+		data += stride;
+	}
+}
+
+/* where to put the luma and chroma of a row before packing them */
+static guint8 * _gst_egueb_converter_scratch_new(GstVideoFormat fmt, gint w)
+{
+	if (!gst_video_format_is_yuv(fmt))
+		return NULL;
+	return g_malloc(w + ((w + 1) / 2) * 2);
+}
+
+static void _gst_egueb_converter_yuv(const Gst_Egueb_Converter_Kernels *k,
+		GstVideoFormat fmt, guint8 *sdata, size_t sstride,
+		guint8 *data, gint w, gint h, Eina_Rectangle *clip,
+		guint8 *scratch)
+{
+	guint8 *yp, *up, *vp;
+	guint8 *ty, *tu, *tv;
+	gint ystride, ustride, vstride;
+	gint cw;
+	gint y;
+
+	ystride = gst_video_format_get_row_stride(fmt, 0, w);
+	ustride = gst_video_format_get_row_stride(fmt, 1, w);
+	vstride = gst_video_format_get_row_stride(fmt, 2, w);
+	yp = data + gst_video_format_get_component_offset(fmt, 0, w, h);
+	up = data + gst_video_format_get_component_offset(fmt, 1, w, h);
+	vp = data + gst_video_format_get_component_offset(fmt, 2, w, h);
+
+	cw = (clip->w + 1) / 2;
+	ty = scratch;
+	tu = ty + clip->w;
+	tv = tu + cw;
+
+	for (y = clip->y; y < clip->y + clip->h; y++)
+	{
+		const guint32 *s0 = (const guint32 *)sdata;
+		const guint32 *s1 = s0;
+		gint i;
+
+		if (fmt == GST_VIDEO_FORMAT_YUY2)
+		{
+			guint8 *d = yp + (y * ystride) + (clip->x * 2);
+
+			k->luma(ty, s0, clip->w);
+			k->chroma(tu, tv, s0, s0, clip->w);
+			for (i = 0; i < cw; i++, d += 4)
+			{
+				d[0] = ty[i * 2];
+				d[1] = tu[i];
+				d[2] = i * 2 + 1 < clip->w ? ty[i * 2 + 1] : ty[i * 2];
+				d[3] = tv[i];
+			}
+			sdata += sstride;
+			continue;
+		}
+
+		/* 4:2:0, two rows at once */
+		k->luma(yp + (y * ystride) + clip->x, s0, clip->w);
+		if (y + 1 < clip->y + clip->h)
+		{
+			s1 = (const guint32 *)(sdata + sstride);
+			k->luma(yp + ((y + 1) * ystride) + clip->x, s1,
+					clip->w);
+		}
+
+		if (fmt == GST_VIDEO_FORMAT_I420)
+		{
+			k->chroma(up + ((y / 2) * ustride) + (clip->x / 2),
+					vp + ((y / 2) * vstride) + (clip->x / 2),
+					s0, s1, clip->w);
+		}
+		else
+		{
+			guint8 *d = up + ((y / 2) * ustride) + clip->x;
+
+			k->chroma(tu, tv, s0, s1, clip->w);
+			for (i = 0; i < cw; i++, d += 2)
+			{
+				d[0] = tu[i];
+				d[1] = tv[i];
+			}
+		}
+		sdata += sstride * 2;
+		y++;
+	}
+}
+
+static void _gst_egueb_converter_area(Enesim_Surface *s, GstVideoFormat fmt,
+		gboolean premultiplied, guint8 *data, Eina_Rectangle *area,
+		guint8 *scratch)
+{
+	const Gst_Egueb_Converter_Kernels *k;
+	Eina_Rectangle clip;
+	guint8 *sdata;
+	size_t sstride;
+	gint sw, sh;
+
+	if (!enesim_surface_data_get(s, (void **)&sdata, &sstride))
+		return;
+	enesim_surface_size_get(s, &sw, &sh);
+
+	eina_rectangle_coords_from(&clip, 0, 0, sw, sh);
+	if (area && !eina_rectangle_intersection(&clip, area))
+		return;
+
+	/* the chroma is shared between pairs of pixels, convert both */
+	if (gst_video_format_is_yuv(fmt))
+	{
+		clip.w += clip.x & 1;
+		clip.x &= ~1;
+		clip.h += clip.y & 1;
+		clip.y &= ~1;
+		clip.w = MIN((clip.w + 1) & ~1, sw - clip.x);
+		clip.h = MIN((clip.h + 1) & ~1, sh - clip.y);
+	}
+
+	k = _gst_egueb_converter_kernels_get();
+	sdata += (clip.y * sstride) + (clip.x * 4);
+	switch (fmt)
+	{
+		case GST_VIDEO_FORMAT_BGRx:
+		_gst_egueb_converter_rgb(k->xrgb, sdata, sstride, data, sw,
+				&clip);
+		break;
+
+		case GST_VIDEO_FORMAT_BGRA:
+		_gst_egueb_converter_rgb(premultiplied ?
+				_gst_egueb_converter_argb8888_copy : k->argb,
+				sdata, sstride, data, sw, &clip);
+		break;
+
+		case GST_VIDEO_FORMAT_I420:
+		case GST_VIDEO_FORMAT_NV12:
+		case GST_VIDEO_FORMAT_YUY2:
+		_gst_egueb_converter_yuv(k, fmt, sdata, sstride, data, sw, sh,
+				&clip, scratch);
+		break;
+
+		default:
+		g_warning("Unsupported format %d", fmt);
+		break;
+	}
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+const gchar * gst_egueb_converter_kernels_name_get(void)
+{
+	return _gst_egueb_converter_kernels_get()->name;
+}
+
+/* Force the kernels to use by their name, NULL goes back to the best ones
+ * for this CPU. It is not thread safe, it is meant for the checks only.
+ * Returns FALSE if the kernels do not exist or the CPU can not run them
+ */
+gboolean gst_egueb_converter_kernels_set(const gchar *name)
+{
+	gint i;
+
+	if (!name)
+	{
+		_kernels_forced = NULL;
+		return TRUE;
+	}
+
+	for (i = 0; _kernels[i]; i++)
+	{
+		if (strcmp(_kernels[i]->name, name))
+			continue;
+		if (!_gst_egueb_converter_kernels_runnable(_kernels[i]))
+			return FALSE;
+		_kernels_forced = _kernels[i];
+		return TRUE;
+	}
+	return FALSE;
+}
+
+gboolean gst_egueb_converter_format_supported(GstVideoFormat fmt)
+{
+	switch (fmt)
+	{
+		case GST_VIDEO_FORMAT_BGRx:
+		case GST_VIDEO_FORMAT_BGRA:
+		case GST_VIDEO_FORMAT_I420:
+		case GST_VIDEO_FORMAT_NV12:
+		case GST_VIDEO_FORMAT_YUY2:
+		return TRUE;
+
+		default:
+		return FALSE;
+	}
+}
+
+void gst_egueb_converter_surface_area(Enesim_Surface *s, GstVideoFormat fmt,
+		gboolean premultiplied, guint8 *data, Eina_Rectangle *area)
+{
+	guint8 *scratch;
+	gint sw, sh;
+
+	enesim_surface_size_get(s, &sw, &sh);
+	scratch = _gst_egueb_converter_scratch_new(fmt, sw);
+	_gst_egueb_converter_area(s, fmt, premultiplied, data, area, scratch);
+	g_free(scratch);
+}
+
+/* the scratch row is shared by all the areas */
+void gst_egueb_converter_surface_list(Enesim_Surface *s, GstVideoFormat fmt,
+		gboolean premultiplied, guint8 *data, Eina_List *areas)
+{
+	Eina_Rectangle *area;
+	Eina_List *l;
+	guint8 *scratch;
+	gint sw, sh;
+
+	if (!areas)
+		return;
+
+	enesim_surface_size_get(s, &sw, &sh);
+	scratch = _gst_egueb_converter_scratch_new(fmt, sw);
+	EINA_LIST_FOREACH(areas, l, area)
+		_gst_egueb_converter_area(s, fmt, premultiplied, data, area,
+				scratch);
+	g_free(scratch);
+}
@@ -0,0 +1,34 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GST_EGUEB_CONVERTER_H_
+#define _GST_EGUEB_CONVERTER_H_
+
+#include <Enesim.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+gboolean gst_egueb_converter_format_supported(GstVideoFormat fmt);
+const gchar * gst_egueb_converter_kernels_name_get(void);
+gboolean gst_egueb_converter_kernels_set(const gchar *name);
+void gst_egueb_converter_surface_area(Enesim_Surface *s, GstVideoFormat fmt,
+		gboolean premultiplied, guint8 *data, Eina_Rectangle *area);
+void gst_egueb_converter_surface_list(Enesim_Surface *s, GstVideoFormat fmt,
+		gboolean premultiplied, guint8 *data, Eina_List *areas);
+
+#endif
@@ -0,0 +1,176 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gst/gst.h>
+#include <Enesim.h>
+
+#include "gst_egueb_coverage.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_egueb_src_debug);
+#define GST_CAT_DEFAULT gst_egueb_src_debug
+
+/* The surface is split in tiles, a tile is opaque when the document alone
+ * covers every pixel of it with full alpha. The coverage is learnt once from
+ * a surface with only the document drawn, after that it can only shrink
+ * whenever a check finds an area that is no longer opaque
+ */
+#define COVERAGE_TILE 16
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+struct _Gst_Egueb_Coverage
+{
+	gint w;
+	gint h;
+	gint tw;
+	gint th;
+	guint8 *opaque;
+};
+
+static gboolean _gst_egueb_coverage_area_opaque(Enesim_Surface *s,
+		Eina_Rectangle *area)
+{
+	guint8 *data;
+	size_t stride;
+	guint32 acc = 0xffffffff;
+	gint x, y;
+
+	if (!enesim_surface_data_get(s, (void **)&data, &stride))
+		return FALSE;
+
+	data += (area->y * stride) + (area->x * 4);
+	for (y = 0; y < area->h; y++)
+	{
+		const guint32 *p = (const guint32 *)data;
+
+		for (x = 0; x < area->w; x++)
+			acc &= p[x];
+		if ((acc >> 24) != 0xff)
+			return FALSE;
+		data += stride;
+	}
+	return TRUE;
+}
+
+/* the tiles touched by an area, FALSE if it is outside */
+static gboolean _gst_egueb_coverage_tiles_get(Gst_Egueb_Coverage *thiz,
+		Eina_Rectangle *area, Eina_Rectangle *tiles)
+{
+	Eina_Rectangle clip;
+
+	eina_rectangle_coords_from(&clip, 0, 0, thiz->w, thiz->h);
+	if (!eina_rectangle_intersection(&clip, area))
+		return FALSE;
+
+	tiles->x = clip.x / COVERAGE_TILE;
+	tiles->y = clip.y / COVERAGE_TILE;
+	tiles->w = ((clip.x + clip.w - 1) / COVERAGE_TILE) - tiles->x + 1;
+	tiles->h = ((clip.y + clip.h - 1) / COVERAGE_TILE) - tiles->y + 1;
+	return TRUE;
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+/* the surface must have only the document drawn */
+Gst_Egueb_Coverage * gst_egueb_coverage_new(Enesim_Surface *s)
+{
+	Gst_Egueb_Coverage *thiz;
+	gint opaque = 0;
+	gint x, y;
+
+	thiz = g_new0(Gst_Egueb_Coverage, 1);
+	enesim_surface_size_get(s, &thiz->w, &thiz->h);
+	thiz->tw = (thiz->w + COVERAGE_TILE - 1) / COVERAGE_TILE;
+	thiz->th = (thiz->h + COVERAGE_TILE - 1) / COVERAGE_TILE;
+	thiz->opaque = g_new0(guint8, thiz->tw * thiz->th);
+
+	for (y = 0; y < thiz->th; y++)
+	{
+		for (x = 0; x < thiz->tw; x++)
+		{
+			Eina_Rectangle tile;
+
+			eina_rectangle_coords_from(&tile, x * COVERAGE_TILE,
+					y * COVERAGE_TILE,
+					MIN(COVERAGE_TILE, thiz->w - x * COVERAGE_TILE),
+					MIN(COVERAGE_TILE, thiz->h - y * COVERAGE_TILE));
+			if (_gst_egueb_coverage_area_opaque(s, &tile))
+			{
+				thiz->opaque[y * thiz->tw + x] = 1;
+				opaque++;
+			}
+		}
+	}
+	GST_DEBUG("%d of %d tiles are opaque", opaque, thiz->tw * thiz->th);
+
+	return thiz;
+}
+
+void gst_egueb_coverage_free(Gst_Egueb_Coverage *thiz)
+{
+	g_free(thiz->opaque);
+	g_free(thiz);
+}
+
+/* whether every tile the area touches is opaque */
+gboolean gst_egueb_coverage_opaque_get(Gst_Egueb_Coverage *thiz,
+		Eina_Rectangle *area)
+{
+	Eina_Rectangle tiles;
+	gint x, y;
+
+	if (!_gst_egueb_coverage_tiles_get(thiz, area, &tiles))
+		return FALSE;
+
+	for (y = tiles.y; y < tiles.y + tiles.h; y++)
+	{
+		for (x = tiles.x; x < tiles.x + tiles.w; x++)
+		{
+			if (!thiz->opaque[y * thiz->tw + x])
+				return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/* Check that the document drawn on the area is still opaque, otherwise its
+ * tiles are no longer opaque
+ */
+gboolean gst_egueb_coverage_check(Gst_Egueb_Coverage *thiz,
+		Enesim_Surface *s, Eina_Rectangle *area)
+{
+	Eina_Rectangle tiles;
+	Eina_Rectangle clip;
+	gint x, y;
+
+	eina_rectangle_coords_from(&clip, 0, 0, thiz->w, thiz->h);
+	if (!eina_rectangle_intersection(&clip, area))
+		return TRUE;
+	if (_gst_egueb_coverage_area_opaque(s, &clip))
+		return TRUE;
+
+	GST_DEBUG("Area %d %d %d %d is no longer opaque", clip.x, clip.y,
+			clip.w, clip.h);
+	_gst_egueb_coverage_tiles_get(thiz, &clip, &tiles);
+	for (y = tiles.y; y < tiles.y + tiles.h; y++)
+	{
+		for (x = tiles.x; x < tiles.x + tiles.w; x++)
+			thiz->opaque[y * thiz->tw + x] = 0;
+	}
+	return FALSE;
+}
@@ -0,0 +1,165 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gst/gst.h>
+#include <Eina.h>
+
+#include "gst_egueb_damages.h"
+
+/* The cost of drawing a list of damages is the sum of the areas, where the
+ * overlapped pixels are drawn more than once, plus a fixed cost per
+ * rectangle for setting up the draw. Two rectangles are fused into their
+ * bounding box whenever that does not increase the total cost
+ */
+#define DAMAGES_MAX 128
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+static inline gint64 _gst_egueb_damages_area(const Eina_Rectangle *r)
+{
+	return (gint64)r->w * r->h;
+}
+
+static inline void _gst_egueb_damages_bounds(const Eina_Rectangle *a,
+		const Eina_Rectangle *b, Eina_Rectangle *dst)
+{
+	gint x0, y0, x1, y1;
+
+	x0 = MIN(a->x, b->x);
+	y0 = MIN(a->y, b->y);
+	x1 = MAX(a->x + a->w, b->x + b->w);
+	y1 = MAX(a->y + a->h, b->y + b->h);
+	eina_rectangle_coords_from(dst, x0, y0, x1 - x0, y1 - y0);
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+Eina_List * gst_egueb_damages_append(Eina_List *damages, Eina_Rectangle *area)
+{
+	Eina_Rectangle *r;
+
+	r = malloc(sizeof(Eina_Rectangle));
+	*r = *area;
+	return eina_list_append(damages, r);
+}
+
+void gst_egueb_damages_free(Eina_List *damages)
+{
+	Eina_Rectangle *r;
+
+	EINA_LIST_FREE(damages, r)
+		free(r);
+}
+
+/* Grow every damage to a multiple of align, without going out of the
+ * frame
+ */
+void gst_egueb_damages_align(Eina_List *damages, guint align, gint w, gint h)
+{
+	Eina_Rectangle *r;
+	Eina_List *l;
+
+	EINA_LIST_FOREACH(damages, l, r)
+	{
+		gint x2 = r->x + r->w;
+		gint y2 = r->y + r->h;
+
+		r->x = MAX(r->x - (r->x % (gint)align), 0);
+		r->y = MAX(r->y - (r->y % (gint)align), 0);
+		x2 = MIN(((x2 + align - 1) / align) * align, w);
+		y2 = MIN(((y2 + align - 1) / align) * align, h);
+		r->w = x2 - r->x;
+		r->h = y2 - r->y;
+	}
+}
+
+guint64 gst_egueb_damages_area_get(Eina_List *damages)
+{
+	Eina_Rectangle *r;
+	Eina_List *l;
+	guint64 area = 0;
+
+	EINA_LIST_FOREACH(damages, l, r)
+		area += _gst_egueb_damages_area(r);
+	return area;
+}
+
+/* Greedy merge, on every step the pair with the best saving is fused until
+ * no pair saves anything. The search is quadratic, so when there are too
+ * many damages the consecutive ones are fused first, those usually come
+ * from the same element
+ */
+Eina_List * gst_egueb_damages_coalesce(Eina_List *damages, guint rect_cost)
+{
+	while (eina_list_count(damages) > DAMAGES_MAX)
+	{
+		Eina_List *l;
+
+		for (l = damages; l && eina_list_next(l); l = eina_list_next(l))
+		{
+			Eina_List *next = eina_list_next(l);
+
+			_gst_egueb_damages_bounds(eina_list_data_get(l),
+					eina_list_data_get(next),
+					eina_list_data_get(l));
+			free(eina_list_data_get(next));
+			damages = eina_list_remove_list(damages, next);
+		}
+	}
+
+	while (damages)
+	{
+		Eina_List *l1, *l2;
+		Eina_List *best1 = NULL, *best2 = NULL;
+		Eina_Rectangle best_bounds;
+		gint64 best_saving = -1;
+
+		for (l1 = damages; l1; l1 = eina_list_next(l1))
+		{
+			Eina_Rectangle *r1 = eina_list_data_get(l1);
+
+			for (l2 = eina_list_next(l1); l2; l2 = eina_list_next(l2))
+			{
+				Eina_Rectangle *r2 = eina_list_data_get(l2);
+				Eina_Rectangle bounds;
+				gint64 saving;
+
+				_gst_egueb_damages_bounds(r1, r2, &bounds);
+				saving = _gst_egueb_damages_area(r1) +
+						_gst_egueb_damages_area(r2) + rect_cost -
+						_gst_egueb_damages_area(&bounds);
+				if (saving > best_saving)
+				{
+					best_saving = saving;
+					best_bounds = bounds;
+					best1 = l1;
+					best2 = l2;
+				}
+			}
+		}
+
+		if (!best1)
+			break;
+
+		*((Eina_Rectangle *)eina_list_data_get(best1)) = best_bounds;
+		free(eina_list_data_get(best2));
+		damages = eina_list_remove_list(damages, best2);
+	}
+
+	return damages;
+}
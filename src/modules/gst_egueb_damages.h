@@ -0,0 +1,31 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GST_EGUEB_DAMAGES_H_
+#define _GST_EGUEB_DAMAGES_H_
+
+#include <Eina.h>
+#include <gst/gst.h>
+
+Eina_List * gst_egueb_damages_append(Eina_List *damages, Eina_Rectangle *area);
+void gst_egueb_damages_free(Eina_List *damages);
+void gst_egueb_damages_align(Eina_List *damages, guint align, gint w, gint h);
+guint64 gst_egueb_damages_area_get(Eina_List *damages);
+Eina_List * gst_egueb_damages_coalesce(Eina_List *damages, guint rect_cost);
+
+#endif
@@ -28,7 +28,21 @@ GST_STATIC_PAD_TEMPLATE ("video",
     GST_STATIC_CAPS ("video/x-raw-rgb, "
         "framerate = (fraction) [ 0, MAX ], "
         "depth = 24, bpp = 32, "
-        "width = (int) [ 1, MAX ], height = (int) [ 1, MAX ]")
+        "width = (int) [ 1, MAX ], height = (int) [ 1, MAX ]; "
+        GST_VIDEO_CAPS_BGRA "; "
+        GST_VIDEO_CAPS_YUV ("{ I420, NV12, YUY2 }"))
+    );
+
+static GstStaticPadTemplate gst_egueb_demux_src_video_request_template =
+GST_STATIC_PAD_TEMPLATE ("video_%u",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS ("video/x-raw-rgb, "
+        "framerate = (fraction) [ 0, MAX ], "
+        "depth = 24, bpp = 32, "
+        "width = (int) [ 1, MAX ], height = (int) [ 1, MAX ]; "
+        GST_VIDEO_CAPS_BGRA "; "
+        GST_VIDEO_CAPS_YUV ("{ I420, NV12, YUY2 }"))
     );
 
 static GstElementDetails gst_egueb_demux_details = {
@@ -44,6 +58,7 @@ enum
   PROP_CONTAINER_WIDTH,
   PROP_CONTAINER_HEIGHT,
   PROP_BACKGROUND_COLOR,
+  PROP_VIEWPORT,
   /* FILL ME */
 };
 
@@ -164,6 +179,7 @@ gst_egueb_demux_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_CONTAINER_WIDTH:
     case PROP_CONTAINER_HEIGHT:
     case PROP_BACKGROUND_COLOR:
+    case PROP_VIEWPORT:
       g_object_get_property (G_OBJECT (thiz->src),
           g_param_spec_get_name (pspec), value);
       break;
@@ -188,6 +204,7 @@ gst_egueb_demux_set_property (GObject * object, guint prop_id,
     case PROP_CONTAINER_WIDTH:
     case PROP_CONTAINER_HEIGHT:
     case PROP_BACKGROUND_COLOR:
+    case PROP_VIEWPORT:
       g_object_set_property (G_OBJECT (thiz->src),
           g_param_spec_get_name (pspec), value);
       break;
@@ -197,6 +214,49 @@ gst_egueb_demux_set_property (GObject * object, guint prop_id,
   }
 }
 
+/* the renditions are request pads of the source, just ghost them */
+static GstPad *
+gst_egueb_demux_request_new_pad (GstElement * element, GstPadTemplate * templ,
+    const gchar * name)
+{
+  GstEguebDemux *thiz = GST_EGUEB_DEMUX (element);
+  GstPad *pad;
+  GstPad *ghost_pad;
+
+  if (!thiz->src)
+    return NULL;
+
+  pad = gst_element_get_request_pad (thiz->src, name ? name : "video_%u");
+  if (!pad) {
+    GST_WARNING_OBJECT (thiz, "Unable to request a rendition pad");
+    return NULL;
+  }
+
+  ghost_pad = gst_ghost_pad_new_from_template (GST_PAD_NAME (pad), pad,
+      templ);
+  gst_object_unref (pad);
+  if (GST_STATE (element) > GST_STATE_READY)
+    gst_pad_set_active (ghost_pad, TRUE);
+  gst_element_add_pad (element, ghost_pad);
+
+  return ghost_pad;
+}
+
+static void
+gst_egueb_demux_release_pad (GstElement * element, GstPad * pad)
+{
+  GstEguebDemux *thiz = GST_EGUEB_DEMUX (element);
+  GstPad *target;
+
+  target = gst_ghost_pad_get_target (GST_GHOST_PAD (pad));
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+  if (target) {
+    gst_element_release_request_pad (thiz->src, target);
+    gst_object_unref (target);
+  }
+}
+
 static void
 gst_egueb_demux_dispose (GObject * object)
 {
@@ -232,6 +292,10 @@ gst_egueb_demux_class_init (GstEguebDemuxClass * klass)
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_egueb_demux_change_state);
+  gstelement_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_egueb_demux_request_new_pad);
+  gstelement_class->release_pad =
+      GST_DEBUG_FUNCPTR (gst_egueb_demux_release_pad);
 
   klass->handle_message = gstbin_class->handle_message;
   gstbin_class->handle_message = gst_egueb_demux_handle_message;
@@ -246,6 +310,8 @@ gst_egueb_demux_class_init (GstEguebDemuxClass * klass)
       PROP_CONTAINER_HEIGHT, "height");
   gst_egueb_demux_install_property (gobject_class, egueb_src_class,
       PROP_BACKGROUND_COLOR, "background-color");
+  gst_egueb_demux_install_property (gobject_class, egueb_src_class,
+      PROP_VIEWPORT, "viewport");
   g_type_class_unref (egueb_src_class);
 }
 
@@ -258,6 +324,8 @@ gst_egueb_demux_base_init (gpointer g_class)
       gst_static_pad_template_get (&gst_egueb_demux_sink_template));
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&gst_egueb_demux_src_video_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&gst_egueb_demux_src_video_request_template));
   gst_element_class_set_details (element_class, &gst_egueb_demux_details);
 }
 
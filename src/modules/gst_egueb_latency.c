@@ -0,0 +1,114 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+#include "gst_egueb_latency.h"
+
+/* Keeps the last samples on a ring, the percentiles are computed on a
+ * sorted copy only when asked for, which is far less often than the
+ * samples are added
+ */
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+struct _Gst_Egueb_Latency
+{
+	GstClockTime *samples;
+	GstClockTime *sorted;
+	guint size;
+	guint count;
+	guint next;
+};
+
+static int _gst_egueb_latency_cmp(const void *a, const void *b)
+{
+	GstClockTime ta = *(const GstClockTime *)a;
+	GstClockTime tb = *(const GstClockTime *)b;
+
+	return ta < tb ? -1 : ta > tb ? 1 : 0;
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+Gst_Egueb_Latency * gst_egueb_latency_new(guint size)
+{
+	Gst_Egueb_Latency *thiz;
+
+	thiz = g_new0(Gst_Egueb_Latency, 1);
+	thiz->size = MAX(size, 1);
+	thiz->samples = g_new0(GstClockTime, thiz->size);
+	thiz->sorted = g_new0(GstClockTime, thiz->size);
+
+	return thiz;
+}
+
+void gst_egueb_latency_free(Gst_Egueb_Latency *thiz)
+{
+	g_free(thiz->samples);
+	g_free(thiz->sorted);
+	g_free(thiz);
+}
+
+void gst_egueb_latency_reset(Gst_Egueb_Latency *thiz)
+{
+	thiz->count = 0;
+	thiz->next = 0;
+}
+
+void gst_egueb_latency_add(Gst_Egueb_Latency *thiz, GstClockTime sample)
+{
+	thiz->samples[thiz->next] = sample;
+	thiz->next = (thiz->next + 1) % thiz->size;
+	if (thiz->count < thiz->size)
+		thiz->count++;
+}
+
+guint gst_egueb_latency_count_get(Gst_Egueb_Latency *thiz)
+{
+	return thiz->count;
+}
+
+/* the smallest sample not below the given percent of the samples, or
+ * GST_CLOCK_TIME_NONE when there are no samples yet
+ */
+GstClockTime gst_egueb_latency_percentile_get(Gst_Egueb_Latency *thiz,
+		gdouble percentile)
+{
+	gdouble rank;
+	guint i;
+
+	if (!thiz->count)
+		return GST_CLOCK_TIME_NONE;
+
+	memcpy(thiz->sorted, thiz->samples, thiz->count * sizeof(GstClockTime));
+	qsort(thiz->sorted, thiz->count, sizeof(GstClockTime),
+			_gst_egueb_latency_cmp);
+
+	percentile = CLAMP(percentile, 0.0, 100.0);
+	/* the nearest rank */
+	rank = percentile * thiz->count / 100.0;
+	i = (guint)rank;
+	if (i < rank)
+		i++;
+	if (i > 0)
+		i--;
+	return thiz->sorted[MIN(i, thiz->count - 1)];
+}
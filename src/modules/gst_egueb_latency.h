@@ -0,0 +1,34 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GST_EGUEB_LATENCY_H_
+#define _GST_EGUEB_LATENCY_H_
+
+#include <gst/gst.h>
+
+typedef struct _Gst_Egueb_Latency Gst_Egueb_Latency;
+
+Gst_Egueb_Latency * gst_egueb_latency_new(guint size);
+void gst_egueb_latency_free(Gst_Egueb_Latency *thiz);
+void gst_egueb_latency_reset(Gst_Egueb_Latency *thiz);
+void gst_egueb_latency_add(Gst_Egueb_Latency *thiz, GstClockTime sample);
+guint gst_egueb_latency_count_get(Gst_Egueb_Latency *thiz);
+GstClockTime gst_egueb_latency_percentile_get(Gst_Egueb_Latency *thiz,
+		gdouble percentile);
+
+#endif
@@ -0,0 +1,182 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gst/gst.h>
+
+#include "gst_egueb_navigation.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_egueb_src_debug);
+#define GST_CAT_DEFAULT gst_egueb_src_debug
+
+/* A bounded ring where any thread can push and only one thread drains.
+ * Every slot has a sequence number telling whether it is free for the
+ * position being pushed or holds the event of the position being drained,
+ * so the writers only compete on the position with a compare and exchange
+ * and never wait on each other nor on the reader
+ */
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+typedef struct _Gst_Egueb_Navigation_Slot
+{
+	volatile gint seq;
+	Gst_Egueb_Navigation_Event ev;
+} Gst_Egueb_Navigation_Slot;
+
+struct _Gst_Egueb_Navigation
+{
+	Gst_Egueb_Navigation_Slot *slots;
+	guint mask;
+	volatile gint tail;
+	/* only touched by the reader */
+	gint head;
+	/* the stamps of the merged moves, never more than the slots */
+	GstClockTime *stamps;
+};
+
+static inline gint _gst_egueb_navigation_diff(gint a, gint b)
+{
+	return (gint)((guint)a - (guint)b);
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+/* the size is rounded up to a power of two */
+Gst_Egueb_Navigation * gst_egueb_navigation_new(guint size)
+{
+	Gst_Egueb_Navigation *thiz;
+	guint n = 2;
+	guint i;
+
+	while (n < size)
+		n <<= 1;
+
+	thiz = g_new0(Gst_Egueb_Navigation, 1);
+	thiz->slots = g_new0(Gst_Egueb_Navigation_Slot, n);
+	thiz->mask = n - 1;
+	thiz->stamps = g_new(GstClockTime, n);
+	for (i = 0; i < n; i++)
+		thiz->slots[i].seq = i;
+
+	return thiz;
+}
+
+void gst_egueb_navigation_free(Gst_Egueb_Navigation *thiz)
+{
+	g_free(thiz->stamps);
+	g_free(thiz->slots);
+	g_free(thiz);
+}
+
+/* can be called from any thread, returns FALSE when the ring is full and
+ * the event has been discarded
+ */
+gboolean gst_egueb_navigation_push(Gst_Egueb_Navigation *thiz,
+		Gst_Egueb_Navigation_Event *ev)
+{
+	Gst_Egueb_Navigation_Slot *slot;
+	gint pos;
+
+	pos = g_atomic_int_get(&thiz->tail);
+	for (;;)
+	{
+		gint diff;
+
+		slot = &thiz->slots[pos & thiz->mask];
+		diff = _gst_egueb_navigation_diff(g_atomic_int_get(&slot->seq),
+				pos);
+		if (!diff)
+		{
+			if (g_atomic_int_compare_and_exchange(&thiz->tail, pos,
+					pos + 1))
+				break;
+		}
+		else if (diff < 0)
+		{
+			GST_DEBUG("Navigation queue full, discarding event");
+			return FALSE;
+		}
+		pos = g_atomic_int_get(&thiz->tail);
+	}
+
+	slot->ev = *ev;
+	/* publish the event to the reader */
+	g_atomic_int_set(&slot->seq, pos + 1);
+
+	return TRUE;
+}
+
+/* Must be called always from the same thread. Consecutive mouse moves are
+ * merged into the last one, stamped when the first of them was received,
+ * and the stamps of every merged move are given with it. The moves are
+ * still given before the other events so those happen where the pointer
+ * was. Returns the number of events taken from the ring
+ */
+guint gst_egueb_navigation_drain(Gst_Egueb_Navigation *thiz,
+		Gst_Egueb_Navigation_Cb cb, gpointer data)
+{
+	Gst_Egueb_Navigation_Event move;
+	gboolean moved = FALSE;
+	guint moves = 0;
+	guint count = 0;
+
+	for (;;)
+	{
+		Gst_Egueb_Navigation_Slot *slot;
+		Gst_Egueb_Navigation_Event ev;
+
+		slot = &thiz->slots[thiz->head & thiz->mask];
+		if (_gst_egueb_navigation_diff(g_atomic_int_get(&slot->seq),
+				thiz->head + 1) < 0)
+			break;
+
+		ev = slot->ev;
+		/* the slot is free again for the next round of the ring */
+		g_atomic_int_set(&slot->seq, thiz->head + thiz->mask + 1);
+		thiz->head++;
+		count++;
+
+		if (ev.type == GST_EGUEB_NAVIGATION_MOUSE_MOVE)
+		{
+			/* the ring can be filled again while draining */
+			if (moves > thiz->mask)
+			{
+				cb(&move, thiz->stamps, moves, data);
+				moves = 0;
+				moved = FALSE;
+			}
+			thiz->stamps[moves++] = ev.stamp;
+			if (moved)
+				ev.stamp = move.stamp;
+			move = ev;
+			moved = TRUE;
+			continue;
+		}
+		if (moved)
+		{
+			cb(&move, thiz->stamps, moves, data);
+			moved = FALSE;
+			moves = 0;
+		}
+		cb(&ev, &ev.stamp, 1, data);
+	}
+	if (moved)
+		cb(&move, thiz->stamps, moves, data);
+
+	return count;
+}
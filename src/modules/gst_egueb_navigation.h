@@ -0,0 +1,59 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GST_EGUEB_NAVIGATION_H_
+#define _GST_EGUEB_NAVIGATION_H_
+
+#include <gst/gst.h>
+
+#define GST_EGUEB_NAVIGATION_KEY_LENGTH 32
+
+typedef enum _Gst_Egueb_Navigation_Type
+{
+	GST_EGUEB_NAVIGATION_MOUSE_MOVE,
+	GST_EGUEB_NAVIGATION_MOUSE_DOWN,
+	GST_EGUEB_NAVIGATION_MOUSE_UP,
+	GST_EGUEB_NAVIGATION_KEY_DOWN,
+	GST_EGUEB_NAVIGATION_KEY_UP,
+} Gst_Egueb_Navigation_Type;
+
+typedef struct _Gst_Egueb_Navigation_Event
+{
+	Gst_Egueb_Navigation_Type type;
+	gdouble x;
+	gdouble y;
+	gint button;
+	gchar key[GST_EGUEB_NAVIGATION_KEY_LENGTH];
+	/* when the event was received */
+	GstClockTime stamp;
+} Gst_Egueb_Navigation_Event;
+
+typedef struct _Gst_Egueb_Navigation Gst_Egueb_Navigation;
+
+/* the stamps of every event the given one stands for */
+typedef void (*Gst_Egueb_Navigation_Cb)(Gst_Egueb_Navigation_Event *ev,
+		const GstClockTime *stamps, guint count, gpointer data);
+
+Gst_Egueb_Navigation * gst_egueb_navigation_new(guint size);
+void gst_egueb_navigation_free(Gst_Egueb_Navigation *thiz);
+gboolean gst_egueb_navigation_push(Gst_Egueb_Navigation *thiz,
+		Gst_Egueb_Navigation_Event *ev);
+guint gst_egueb_navigation_drain(Gst_Egueb_Navigation *thiz,
+		Gst_Egueb_Navigation_Cb cb, gpointer data);
+
+#endif
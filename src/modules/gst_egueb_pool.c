@@ -0,0 +1,209 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gst/gst.h>
+
+#include "gst_egueb_pool.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_egueb_src_debug);
+#define GST_CAT_DEFAULT gst_egueb_src_debug
+
+/* Every block of memory has a header right before the data of the buffer,
+ * so when the buffer is freed the block can find its way back to the pool.
+ * The pool is kept alive until every block has returned to it
+ */
+#define POOL_ALIGN 32
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+typedef struct _Gst_Egueb_Pool_Block
+{
+	Gst_Egueb_Pool *pool;
+	gpointer mem;
+	gint size;
+} Gst_Egueb_Pool_Block;
+
+struct _Gst_Egueb_Pool
+{
+	GMutex *lock;
+	/* blocks ready to be used */
+	GSList *blocks;
+	guint nblocks;
+	guint max;
+	gint size;
+	/* the pool plus every block given */
+	gint ref;
+};
+
+static void _gst_egueb_pool_unref(Gst_Egueb_Pool *thiz)
+{
+	if (!g_atomic_int_dec_and_test(&thiz->ref))
+		return;
+
+	g_mutex_free(thiz->lock);
+	g_free(thiz);
+}
+
+static Gst_Egueb_Pool_Block * _gst_egueb_pool_block_get(gpointer data)
+{
+	return (Gst_Egueb_Pool_Block *)((guint8 *)data -
+			sizeof(Gst_Egueb_Pool_Block));
+}
+
+static gpointer _gst_egueb_pool_block_data(Gst_Egueb_Pool_Block *b)
+{
+	return (guint8 *)b + sizeof(Gst_Egueb_Pool_Block);
+}
+
+static Gst_Egueb_Pool_Block * _gst_egueb_pool_block_new(Gst_Egueb_Pool *thiz,
+		gint size)
+{
+	Gst_Egueb_Pool_Block *b;
+	gpointer mem;
+	guintptr data;
+
+	mem = g_malloc(size + sizeof(Gst_Egueb_Pool_Block) + POOL_ALIGN);
+	data = ((guintptr)mem + sizeof(Gst_Egueb_Pool_Block) + POOL_ALIGN - 1) &
+			~((guintptr)POOL_ALIGN - 1);
+	b = _gst_egueb_pool_block_get((gpointer)data);
+	b->pool = thiz;
+	b->mem = mem;
+	b->size = size;
+
+	return b;
+}
+
+static void _gst_egueb_pool_block_free(Gst_Egueb_Pool_Block *b)
+{
+	g_free(b->mem);
+}
+
+/* the free function of every buffer of the pool */
+static void _gst_egueb_pool_data_free(gpointer data)
+{
+	Gst_Egueb_Pool_Block *b;
+	Gst_Egueb_Pool *thiz;
+
+	b = _gst_egueb_pool_block_get(data);
+	thiz = b->pool;
+
+	g_mutex_lock(thiz->lock);
+	/* keep it only if it is still useful */
+	if (b->size == thiz->size && thiz->nblocks < thiz->max)
+	{
+		thiz->blocks = g_slist_prepend(thiz->blocks, b);
+		thiz->nblocks++;
+		b = NULL;
+	}
+	g_mutex_unlock(thiz->lock);
+
+	if (b)
+		_gst_egueb_pool_block_free(b);
+	_gst_egueb_pool_unref(thiz);
+}
+
+/* must be called with the lock held */
+static void _gst_egueb_pool_blocks_free(Gst_Egueb_Pool *thiz, guint keep)
+{
+	while (thiz->nblocks > keep)
+	{
+		Gst_Egueb_Pool_Block *b = thiz->blocks->data;
+
+		thiz->blocks = g_slist_delete_link(thiz->blocks, thiz->blocks);
+		thiz->nblocks--;
+		_gst_egueb_pool_block_free(b);
+	}
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+Gst_Egueb_Pool * gst_egueb_pool_new(void)
+{
+	Gst_Egueb_Pool *thiz;
+
+	thiz = g_new0(Gst_Egueb_Pool, 1);
+	thiz->lock = g_mutex_new();
+	thiz->ref = 1;
+
+	return thiz;
+}
+
+/* the buffers still in use will free their memory once done */
+void gst_egueb_pool_free(Gst_Egueb_Pool *thiz)
+{
+	g_mutex_lock(thiz->lock);
+	_gst_egueb_pool_blocks_free(thiz, 0);
+	thiz->max = 0;
+	g_mutex_unlock(thiz->lock);
+	_gst_egueb_pool_unref(thiz);
+}
+
+void gst_egueb_pool_max_set(Gst_Egueb_Pool *thiz, guint max)
+{
+	g_mutex_lock(thiz->lock);
+	thiz->max = max;
+	_gst_egueb_pool_blocks_free(thiz, max);
+	g_mutex_unlock(thiz->lock);
+}
+
+void gst_egueb_pool_flush(Gst_Egueb_Pool *thiz)
+{
+	g_mutex_lock(thiz->lock);
+	_gst_egueb_pool_blocks_free(thiz, 0);
+	/* the buffers in use will not come back */
+	thiz->size = 0;
+	g_mutex_unlock(thiz->lock);
+}
+
+GstBuffer * gst_egueb_pool_buffer_get(Gst_Egueb_Pool *thiz, gint size)
+{
+	Gst_Egueb_Pool_Block *b = NULL;
+	GstBuffer *buffer;
+	gpointer data;
+
+	g_mutex_lock(thiz->lock);
+	if (size != thiz->size)
+	{
+		GST_DEBUG("Using blocks of %d bytes", size);
+		_gst_egueb_pool_blocks_free(thiz, 0);
+		thiz->size = size;
+	}
+	if (thiz->blocks)
+	{
+		b = thiz->blocks->data;
+		thiz->blocks = g_slist_delete_link(thiz->blocks, thiz->blocks);
+		thiz->nblocks--;
+	}
+	g_mutex_unlock(thiz->lock);
+
+	if (!b)
+	{
+		GST_LOG("Allocating a new block of %d bytes", size);
+		b = _gst_egueb_pool_block_new(thiz, size);
+	}
+	g_atomic_int_inc(&thiz->ref);
+
+	data = _gst_egueb_pool_block_data(b);
+	buffer = gst_buffer_new();
+	GST_BUFFER_DATA(buffer) = data;
+	GST_BUFFER_MALLOCDATA(buffer) = data;
+	GST_BUFFER_SIZE(buffer) = size;
+	GST_BUFFER_FREE_FUNC(buffer) = _gst_egueb_pool_data_free;
+
+	return buffer;
+}
@@ -0,0 +1,141 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gst/gst.h>
+
+#include "gst_egueb_qos.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_egueb_src_debug);
+#define GST_CAT_DEFAULT gst_egueb_src_debug
+
+/* The proportion of every QoS event is smoothed, so a single late frame
+ * does not change anything. The level goes one step down when downstream
+ * is consistently late, and one step up when it has been consistently
+ * early for a longer time, so it does not oscillate between two levels
+ */
+#define QOS_WEIGHT 0.25
+#define QOS_DEGRADE 1.2
+#define QOS_RECOVER 0.8
+#define QOS_DEGRADE_EVENTS 8
+#define QOS_RECOVER_EVENTS 32
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+struct _Gst_Egueb_Qos
+{
+	Gst_Egueb_Qos_Level level;
+	Gst_Egueb_Qos_Level max;
+	gdouble proportion;
+	/* the events since the last change of level */
+	guint events;
+};
+
+static void _gst_egueb_qos_level_set(Gst_Egueb_Qos *thiz,
+		Gst_Egueb_Qos_Level level)
+{
+	GST_DEBUG("Changing the QoS level from %d to %d with a proportion "
+			"of %g", thiz->level, level, thiz->proportion);
+	thiz->level = level;
+	thiz->events = 0;
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+Gst_Egueb_Qos * gst_egueb_qos_new(void)
+{
+	Gst_Egueb_Qos *thiz;
+
+	thiz = g_new0(Gst_Egueb_Qos, 1);
+	thiz->max = GST_EGUEB_QOS_LEVELS - 1;
+	gst_egueb_qos_reset(thiz);
+
+	return thiz;
+}
+
+void gst_egueb_qos_free(Gst_Egueb_Qos *thiz)
+{
+	g_free(thiz);
+}
+
+void gst_egueb_qos_max_set(Gst_Egueb_Qos *thiz, Gst_Egueb_Qos_Level max)
+{
+	thiz->max = MIN(max, GST_EGUEB_QOS_LEVELS - 1);
+	if (thiz->level > thiz->max)
+		_gst_egueb_qos_level_set(thiz, thiz->max);
+}
+
+void gst_egueb_qos_reset(Gst_Egueb_Qos *thiz)
+{
+	thiz->level = GST_EGUEB_QOS_LEVEL_NONE;
+	thiz->proportion = 1.0;
+	thiz->events = 0;
+}
+
+/* returns whether the level has changed */
+gboolean gst_egueb_qos_update(Gst_Egueb_Qos *thiz, gdouble proportion,
+		GstClockTimeDiff diff)
+{
+	thiz->proportion = thiz->proportion * (1 - QOS_WEIGHT) +
+			proportion * QOS_WEIGHT;
+	thiz->events++;
+
+	/* only when the frames are really arriving late */
+	if (diff > 0 && thiz->proportion > QOS_DEGRADE &&
+			thiz->events >= QOS_DEGRADE_EVENTS &&
+			thiz->level < thiz->max)
+	{
+		_gst_egueb_qos_level_set(thiz, thiz->level + 1);
+		return TRUE;
+	}
+
+	if (diff <= 0 && thiz->proportion < QOS_RECOVER &&
+			thiz->events >= QOS_RECOVER_EVENTS &&
+			thiz->level > GST_EGUEB_QOS_LEVEL_NONE)
+	{
+		_gst_egueb_qos_level_set(thiz, thiz->level - 1);
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+Gst_Egueb_Qos_Level gst_egueb_qos_level_get(Gst_Egueb_Qos *thiz)
+{
+	return thiz->level;
+}
+
+gdouble gst_egueb_qos_proportion_get(Gst_Egueb_Qos *thiz)
+{
+	return thiz->proportion;
+}
+
+/* every other frame is the previous one again */
+gboolean gst_egueb_qos_level_skip(Gst_Egueb_Qos_Level level)
+{
+	return level == GST_EGUEB_QOS_LEVEL_SKIP ||
+			level == GST_EGUEB_QOS_LEVEL_HALF_SKIP;
+}
+
+/* the document is drawn at a fraction of the size and scaled up */
+gint gst_egueb_qos_level_scale(Gst_Egueb_Qos_Level level)
+{
+	if (level == GST_EGUEB_QOS_LEVEL_HALF ||
+			level == GST_EGUEB_QOS_LEVEL_HALF_SKIP)
+		return 2;
+	return 1;
+}
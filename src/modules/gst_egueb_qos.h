@@ -0,0 +1,48 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GST_EGUEB_QOS_H_
+#define _GST_EGUEB_QOS_H_
+
+#include <gst/gst.h>
+
+/* From the best quality to the cheapest one */
+typedef enum _Gst_Egueb_Qos_Level
+{
+	GST_EGUEB_QOS_LEVEL_NONE,
+	GST_EGUEB_QOS_LEVEL_SKIP,
+	GST_EGUEB_QOS_LEVEL_HALF,
+	GST_EGUEB_QOS_LEVEL_HALF_SKIP,
+	GST_EGUEB_QOS_LEVELS,
+} Gst_Egueb_Qos_Level;
+
+typedef struct _Gst_Egueb_Qos Gst_Egueb_Qos;
+
+Gst_Egueb_Qos * gst_egueb_qos_new(void);
+void gst_egueb_qos_free(Gst_Egueb_Qos *thiz);
+void gst_egueb_qos_max_set(Gst_Egueb_Qos *thiz, Gst_Egueb_Qos_Level max);
+void gst_egueb_qos_reset(Gst_Egueb_Qos *thiz);
+gboolean gst_egueb_qos_update(Gst_Egueb_Qos *thiz, gdouble proportion,
+		GstClockTimeDiff diff);
+Gst_Egueb_Qos_Level gst_egueb_qos_level_get(Gst_Egueb_Qos *thiz);
+gdouble gst_egueb_qos_proportion_get(Gst_Egueb_Qos *thiz);
+
+gboolean gst_egueb_qos_level_skip(Gst_Egueb_Qos_Level level);
+gint gst_egueb_qos_level_scale(Gst_Egueb_Qos_Level level);
+
+#endif
@@ -1,5 +1,9 @@
+#include <stdio.h>
+
 #include "gst_egueb_src.h"
 #include "gst_egueb_type.h"
+#include "gst_egueb_converter.h"
+#include "gst_egueb_damages.h"
 
 GST_DEBUG_CATEGORY_EXTERN (gst_egueb_src_debug);
 #define GST_CAT_DEFAULT gst_egueb_src_debug
@@ -7,6 +11,13 @@ GST_DEBUG_CATEGORY_EXTERN (gst_egueb_src_debug);
 GST_BOILERPLATE (GstEguebSrc, gst_egueb_src, GstBaseSrc,
     GST_TYPE_BASE_SRC);
 
+#define GST_EGUEB_SRC_CAPS "video/x-raw-rgb, " \
+    "framerate = (fraction) [ 0, MAX ], " \
+    "depth = 24, bpp = 32, " \
+    "width = (int) [ 1, MAX ], height = (int) [ 1, MAX ]; " \
+    GST_VIDEO_CAPS_BGRA "; " \
+    GST_VIDEO_CAPS_YUV ("{ I420, NV12, YUY2 }")
+
 /* Later, whenever egueb supports more than svg, we can
  * add more templates here
  */
@@ -14,10 +25,15 @@ static GstStaticPadTemplate gst_egueb_src_src_factory =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS ("video/x-raw-rgb, "
-        "framerate = (fraction) [ 0, MAX ], "
-        "depth = 24, bpp = 32, "
-        "width = (int) [ 1, MAX ], height = (int) [ 1, MAX ]")
+    GST_STATIC_CAPS (GST_EGUEB_SRC_CAPS)
+    );
+
+/* every rendition of the same document has its own pad */
+static GstStaticPadTemplate gst_egueb_src_video_factory =
+GST_STATIC_PAD_TEMPLATE ("video_%u",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS (GST_EGUEB_SRC_CAPS)
     );
 
 static GstElementDetails gst_egueb_src_details = {
@@ -27,6 +43,39 @@ static GstElementDetails gst_egueb_src_details = {
   "<enesim-devel@googlegroups.com>",
 };
 
+#define DEFAULT_DAMAGE_RECT_COST 1024
+#define DEFAULT_MAX_BUFFERS 4
+#define DEFAULT_CACHE_MAX_BYTES (64 * 1024 * 1024)
+#define DEFAULT_CACHE_DIR_MAX_BYTES (G_GUINT64_CONSTANT (1) << 30)
+/* how far a frame can be from its place on the loop period */
+#define CACHE_FRAME_TOLERANCE GST_USECOND
+#define DEFAULT_QOS_MAX_LEVEL (GST_EGUEB_QOS_LEVELS - 1)
+#define DEFAULT_SKIP_LATE FALSE
+#define DEFAULT_STILL_MODE GST_EGUEB_SRC_STILL_MODE_EOS
+#define DEFAULT_IS_LIVE FALSE
+/* the frames the render latency is measured on, and the percentile
+ * reported
+ */
+#define LATENCY_SAMPLES 256
+#define LATENCY_PERCENTILE 99.0
+#define LATENCY_MIN_SAMPLES 16
+/* the percentile is computed again once every this many samples */
+#define LATENCY_UPDATE_SAMPLES 16
+#define NAVIGATION_EVENTS 256
+/* the upper limits of the input latency ranges, the last one has none */
+static const GstClockTime input_buckets[GST_EGUEB_SRC_INPUT_BUCKETS - 1] = {
+  8 * GST_MSECOND, 16 * GST_MSECOND, 33 * GST_MSECOND, 50 * GST_MSECOND,
+  100 * GST_MSECOND, 200 * GST_MSECOND, 500 * GST_MSECOND,
+};
+static const gchar *input_bucket_names[GST_EGUEB_SRC_INPUT_BUCKETS] = {
+  "le-8ms", "le-16ms", "le-33ms", "le-50ms", "le-100ms", "le-200ms",
+  "le-500ms", "gt-500ms",
+};
+/* the damages are aligned to the macroblocks of the encoders when the output
+ * is YUV
+ */
+#define YUV_DAMAGE_ALIGN 16
+
 enum
 {
   PROP_0,
@@ -35,14 +84,64 @@ enum
   PROP_CONTAINER_HEIGHT,
   PROP_BACKGROUND_COLOR,
   PROP_URI,
+  PROP_ZERO_COPY,
+  PROP_MARK_REPEATED,
+  PROP_DAMAGE_RECT_COST,
+  PROP_DAMAGE_PIXELS,
+  PROP_DAMAGE_PIXELS_SAVED,
+  PROP_PIPELINE,
+  PROP_PREMULTIPLIED,
+  PROP_MAX_BUFFERS,
+  PROP_VIEWPORT,
+  PROP_LOOP_PERIOD,
+  PROP_CACHE_MAX_BYTES,
+  PROP_CACHE_HITS,
+  PROP_CACHE_MISSES,
+  PROP_CACHE_DIR,
+  PROP_CACHE_DIR_MAX_BYTES,
+  PROP_SEEK_SNAP,
+  PROP_QOS_LEVEL,
+  PROP_QOS_MAX_LEVEL,
+  PROP_SKIP_LATE,
+  PROP_FRAMES_DROPPED,
+  PROP_STILL_MODE,
+  PROP_IS_LIVE,
+  PROP_LATENCY,
+  PROP_INPUT_LATENCY_STATS,
   /* FILL ME */
 };
 
+#define GST_TYPE_EGUEB_SRC_STILL_MODE (gst_egueb_src_still_mode_get_type ())
+static GType
+gst_egueb_src_still_mode_get_type (void)
+{
+  static GType type = 0;
+  static const GEnumValue values[] = {
+    {GST_EGUEB_SRC_STILL_MODE_EOS, "Send an EOS after the frame", "eos"},
+    {GST_EGUEB_SRC_STILL_MODE_REPEAT,
+        "Repeat the frame at the negotiated framerate", "repeat"},
+    {GST_EGUEB_SRC_STILL_MODE_STILL,
+        "Send the frame once with a framerate of 0/1", "still"},
+    {0, NULL, NULL},
+  };
+
+  if (!type)
+    type = g_enum_register_static ("GstEguebSrcStillMode", values);
+  return type;
+}
+
+/* must be called with the object locked */
 static void
-gst_egueb_src_buffer_free (void *data, void *user_data)
+gst_egueb_src_input_stats_reset (GstEguebSrc * thiz)
 {
-  Enesim_Buffer_Sw_Data *sdata = data;
-  g_free (sdata->rgb888.plane0);
+  gint i;
+
+  gst_egueb_latency_reset (thiz->input_latency);
+  thiz->input_events = 0;
+  thiz->input_min = GST_CLOCK_TIME_NONE;
+  thiz->input_max = GST_CLOCK_TIME_NONE;
+  for (i = 0; i < GST_EGUEB_SRC_INPUT_BUCKETS; i++)
+    thiz->input_histogram[i] = 0;
 }
 
 static gboolean
@@ -120,9 +219,35 @@ gst_egueb_src_setup (GstEguebSrc * thiz)
   thiz->animation = egueb_dom_node_feature_get(thiz->topmost,
       EGUEB_SMIL_FEATURE_ANIMATION_NAME, NULL);
 
+  GST_DEBUG_OBJECT (thiz, "Using the %s conversion kernels",
+      gst_egueb_converter_kernels_name_get ());
+
   /* setup our own gst egueb document */
   thiz->gdoc = gst_egueb_document_new (egueb_dom_node_ref(thiz->doc));
   gst_egueb_document_feature_io_setup (thiz->gdoc);
+
+  /* the frames rendered on previous runs */
+  if (thiz->cache_dir && !thiz->store) {
+    thiz->store = gst_egueb_store_new (thiz->cache_dir);
+    if (thiz->store)
+      gst_egueb_store_max_set (thiz->store, thiz->cache_dir_max_bytes);
+  }
+  thiz->store_dirty = TRUE;
+  thiz->diverged = FALSE;
+  GST_OBJECT_LOCK (thiz);
+  gst_egueb_qos_reset (thiz->qos);
+  thiz->earliest = GST_CLOCK_TIME_NONE;
+  thiz->processed = 0;
+  thiz->dropped = 0;
+  gst_egueb_latency_reset (thiz->latency);
+  thiz->latency_samples = 0;
+  thiz->latency_reported = GST_CLOCK_TIME_NONE;
+  thiz->latency_configured = GST_CLOCK_TIME_NONE;
+  gst_egueb_src_input_stats_reset (thiz);
+  GST_OBJECT_UNLOCK (thiz);
+  g_array_set_size (thiz->input_applied, 0);
+  g_array_set_size (thiz->input_ready, 0);
+  thiz->frame_sent = FALSE;
   ret = TRUE;
 
 no_window:
@@ -180,10 +305,40 @@ gst_egueb_src_cleanup (GstEguebSrc * thiz)
     thiz->location = NULL;
   }
 
+  if (thiz->store) {
+    gst_egueb_store_free (thiz->store);
+    thiz->store = NULL;
+  }
+
+  if (thiz->cache_dir) {
+    g_free (thiz->cache_dir);
+    thiz->cache_dir = NULL;
+  }
+
   if (thiz->xml) {
     gst_buffer_unref (thiz->xml);
     thiz->xml = NULL;
   }
+
+  if (thiz->last) {
+    gst_buffer_unref (thiz->last);
+    thiz->last = NULL;
+  }
+
+  if (thiz->s) {
+    enesim_surface_unref (thiz->s);
+    thiz->s = NULL;
+  }
+
+  if (thiz->small) {
+    enesim_surface_unref (thiz->small);
+    thiz->small = NULL;
+  }
+
+  if (thiz->coverage) {
+    gst_egueb_coverage_free (thiz->coverage);
+    thiz->coverage = NULL;
+  }
 }
 
 static Eina_Bool
@@ -191,377 +346,2415 @@ gst_egueb_src_damages_get_cb (Egueb_Dom_Feature *f EINA_UNUSED,
     Eina_Rectangle *area, void *data)
 {
   GstEguebSrc * thiz = data;
-  Eina_Rectangle *r;
+  Eina_Rectangle damage = *area;
 
   GST_LOG_OBJECT (thiz, "Damage added at %d %d -> %d %d", area->x, area->y,
       area->w, area->h);
-  r = malloc (sizeof(Eina_Rectangle));
-  *r = *area;
-  thiz->damages = eina_list_append (thiz->damages, r);
+  /* the document is laid out smaller, the damages are on the output size */
+  if (thiz->scale > 1) {
+    damage.x *= thiz->scale;
+    damage.y *= thiz->scale;
+    damage.w *= thiz->scale;
+    damage.h *= thiz->scale;
+  }
+  /* only what is inside the viewport is drawn, on surface coordinates */
+  if (thiz->roi) {
+    Eina_Rectangle bounds;
+
+    eina_rectangle_coords_from (&bounds, 0, 0, thiz->w, thiz->h);
+    damage.x -= thiz->roi_x;
+    damage.y -= thiz->roi_y;
+    if (!eina_rectangle_intersection (&damage, &bounds))
+      return EINA_TRUE;
+  }
+  thiz->damages = gst_egueb_damages_append (thiz->damages, &damage);
 
   return EINA_TRUE;
 }
 
-static Eina_Bool
-gst_egueb_src_draw (GstEguebSrc * thiz)
+static void
+gst_egueb_src_damages_clear (GstEguebSrc * thiz)
 {
-  Eina_Rectangle *r;
+  gst_egueb_damages_free (thiz->damages);
+  thiz->damages = NULL;
+}
 
-  /* draw with the document locked */
-  g_mutex_lock (thiz->doc_lock);
+/* must be called with the document locked. The time of the document is
+ * always the timestamp of the frame, no matter the frames drawn before
+ */
+static void
+gst_egueb_src_animation_time_set (GstEguebSrc * thiz, guint64 ts)
+{
+  if (thiz->animation)
+    egueb_smil_feature_animation_time_set (thiz->animation, ts);
+}
 
+/* must be called with the document locked */
+static Eina_Bool
+gst_egueb_src_process (GstEguebSrc * thiz, Enesim_Surface * s)
+{
   egueb_dom_document_process(thiz->doc);
-  egueb_dom_feature_render_damages_get(thiz->render, thiz->s,
+  egueb_dom_feature_render_damages_get(thiz->render, s,
 				gst_egueb_src_damages_get_cb, thiz);
-  /* in case we dont have any damage, just send again the previous surface converted */
-  if (!thiz->damages) {
-    g_mutex_unlock (thiz->doc_lock);
-    return FALSE;
+  /* the surface has no previous content, draw everything */
+  if (thiz->damage_all) {
+    Eina_Rectangle area;
+
+    gst_egueb_src_damages_clear (thiz);
+    eina_rectangle_coords_from (&area, 0, 0, thiz->w, thiz->h);
+    thiz->damages = gst_egueb_damages_append (thiz->damages, &area);
+    thiz->damage_all = FALSE;
+  } else if (thiz->damages) {
+    guint64 reported;
+    guint64 drawn;
+
+    reported = gst_egueb_damages_area_get (thiz->damages);
+    if (gst_video_format_is_yuv (thiz->format))
+      gst_egueb_damages_align (thiz->damages, YUV_DAMAGE_ALIGN, thiz->w,
+          thiz->h);
+    /* avoid drawing the same pixels more than once */
+    thiz->damages = gst_egueb_damages_coalesce (thiz->damages,
+        thiz->damage_rect_cost);
+    drawn = gst_egueb_damages_area_get (thiz->damages);
+
+    GST_OBJECT_LOCK (thiz);
+    thiz->damage_pixels += reported;
+    thiz->damage_pixels_saved += (gint64) reported - (gint64) drawn;
+    GST_OBJECT_UNLOCK (thiz);
   }
 
-  if (enesim_renderer_background_color_get (thiz->background) != 0) {
-    enesim_renderer_draw_list(thiz->background, thiz->s, ENESIM_ROP_FILL,
-        thiz->damages, 0, 0, NULL);
-    egueb_dom_feature_render_draw_list(thiz->render, thiz->s, ENESIM_ROP_BLEND,
-        thiz->damages, 0, 0, NULL);
-  } else {
-    egueb_dom_feature_render_draw_list(thiz->render, thiz->s, ENESIM_ROP_FILL,
-        thiz->damages, 0, 0, NULL);
-  }
+  return thiz->damages != NULL;
+}
 
-  g_mutex_unlock (thiz->doc_lock);
+/* with alpha on the output the background is composited downstream */
+static guint32
+gst_egueb_src_background_color_get (GstEguebSrc * thiz)
+{
+  if (gst_video_format_has_alpha (thiz->format))
+    return 0;
+  return enesim_renderer_background_color_get (thiz->background);
+}
 
-  EINA_LIST_FREE (thiz->damages, r)
-    free(r);
+/* must be called with the document locked. With a viewport the document
+ * keeps the size of its content and only a part of it is drawn
+ */
+static void
+gst_egueb_src_layout (GstEguebSrc * thiz)
+{
+  if (thiz->roi)
+    egueb_dom_feature_window_content_size_set (thiz->window,
+        MAX (thiz->content_w / thiz->scale, 1),
+        MAX (thiz->content_h / thiz->scale, 1));
+  else
+    egueb_dom_feature_window_content_size_set (thiz->window,
+        MAX (thiz->w / thiz->scale, 1), MAX (thiz->h / thiz->scale, 1));
+}
 
-  return TRUE;
+static void
+gst_egueb_src_draw_document_at (GstEguebSrc * thiz, Enesim_Surface * s,
+    Enesim_Rop rop, Eina_List * areas, gint x, gint y)
+{
+  egueb_dom_feature_render_draw_list (thiz->render, s, rop, areas,
+      x, y, NULL);
 }
 
-static gint
-gst_egueb_src_get_size (GstEguebSrc * thiz)
+static void
+gst_egueb_src_draw_document (GstEguebSrc * thiz, Enesim_Surface * s,
+    Enesim_Rop rop, Eina_List * areas)
+{
+  gst_egueb_src_draw_document_at (thiz, s, rop, areas,
+      thiz->roi_x / thiz->scale, thiz->roi_y / thiz->scale);
+}
+
+/* must be called with the document locked. Without a background the
+ * document is drawn alone
+ */
+static void
+gst_egueb_src_draw (GstEguebSrc * thiz, Enesim_Surface * s,
+    Eina_List * damages, Enesim_Renderer * background)
 {
-  return GST_ROUND_UP_4 (thiz->w * thiz->h * 4);
+  Eina_List *opaque = NULL;
+  Eina_List *rest = NULL;
+  Eina_List *l;
+  Eina_Rectangle *area;
+
+  if (!background) {
+    gst_egueb_src_draw_document (thiz, s, ENESIM_ROP_FILL, damages);
+    return;
+  }
+
+  /* there is no need for the background where the document is opaque */
+  EINA_LIST_FOREACH (damages, l, area) {
+    if (thiz->coverage && gst_egueb_coverage_opaque_get (thiz->coverage,
+        area))
+      opaque = eina_list_append (opaque, area);
+    else
+      rest = eina_list_append (rest, area);
+  }
+
+  if (opaque) {
+    gst_egueb_src_draw_document (thiz, s, ENESIM_ROP_FILL, opaque);
+    /* in case the opaque content has moved draw it again */
+    EINA_LIST_FOREACH (opaque, l, area) {
+      if (!gst_egueb_coverage_check (thiz->coverage, s, area))
+        rest = eina_list_append (rest, area);
+    }
+    eina_list_free (opaque);
+  }
+
+  if (rest) {
+    enesim_renderer_draw_list (background, s, ENESIM_ROP_FILL, rest, 0, 0,
+        NULL);
+    gst_egueb_src_draw_document (thiz, s, ENESIM_ROP_BLEND, rest);
+    eina_list_free (rest);
+  }
 }
 
+/* must be called with the document locked. Find where the document alone
+ * is opaque, it needs the whole surface to be drawn again afterwards
+ */
 static void
-gst_egueb_src_convert (GstEguebSrc * thiz, GstBuffer **buffer)
+gst_egueb_src_coverage_setup (GstEguebSrc * thiz, Enesim_Surface * s,
+    Eina_List * damages)
 {
-  Enesim_Buffer *eb;
-  Eina_Rectangle clip;
+  Eina_Rectangle *area;
+
+  area = eina_list_data_get (damages);
+  if (eina_list_count (damages) != 1 || area->x != 0 || area->y != 0 ||
+      area->w != thiz->w || area->h != thiz->h) {
+    GST_DEBUG_OBJECT (thiz, "Waiting for a full frame to find the coverage");
+    thiz->damage_all = TRUE;
+    return;
+  }
 
-  if (!*buffer) {
-    Enesim_Buffer_Sw_Data sdata;
-    GstBuffer *b;
+  gst_egueb_src_draw_document (thiz, s, ENESIM_ROP_FILL, damages);
+  thiz->coverage = gst_egueb_coverage_new (s);
+}
 
-    sdata.xrgb8888.plane0_stride = GST_ROUND_UP_4 (thiz->w * 4);
-    sdata.xrgb8888.plane0 = (uint32_t *) g_new(guint8,
-        sdata.xrgb8888.plane0_stride * thiz->h);
+static gint
+gst_egueb_src_get_size (GstEguebSrc * thiz)
+{
+  return gst_video_format_get_size (thiz->format, thiz->w, thiz->h);
+}
 
-    eb = enesim_buffer_new_data_from (ENESIM_BUFFER_FORMAT_XRGB8888, thiz->w,
-        thiz->h, EINA_FALSE, &sdata, gst_egueb_src_buffer_free, NULL);
-    enesim_buffer_ref (eb);
+static GstBuffer *
+gst_egueb_src_buffer_get (GstEguebSrc * thiz)
+{
+  GstBaseSrc *src = GST_BASE_SRC (thiz);
+  GstBuffer *buffer = NULL;
+  GstFlowReturn ret;
+  gint size;
 
-    b = gst_buffer_new ();
-    GST_BUFFER_DATA (b) = (guint8 *)sdata.rgb888.plane0;
-    GST_BUFFER_SIZE (b) = sdata.rgb888.plane0_stride * thiz->h;
+  /* in case downstream is done with the last buffer we can update it in
+   * place, it already has the previous frame
+   */
+  if (thiz->last && gst_buffer_is_writable (thiz->last)) {
+    GST_LOG_OBJECT (thiz, "Reusing last buffer");
+    return gst_buffer_ref (thiz->last);
+  }
 
-    /* unref the buffer when done */
-    GST_BUFFER_MALLOCDATA (b) = (guint8 *) eb;
-    GST_BUFFER_FREE_FUNC (b) = (GFreeFunc ) enesim_buffer_unref;
-    *buffer = b;
+  size = gst_egueb_src_get_size (thiz);
+  /* We need to check downstream if the caps have changed so we can
+   * allocate an optimus size of surface
+   */
+  ret = gst_pad_alloc_buffer_and_set_caps (GST_BASE_SRC_PAD (src), src->offset,
+      size, GST_PAD_CAPS (GST_BASE_SRC_PAD (src)), &buffer);
+  if (ret == GST_FLOW_OK) {
+    /* the caps might have changed */
+    size = gst_egueb_src_get_size (thiz);
+    if (GST_BUFFER_SIZE (buffer) != size) {
+      GST_ERROR_OBJECT (thiz, "different size %d %d", GST_BUFFER_SIZE (buffer),
+          size);
+      gst_buffer_unref (buffer);
+      buffer = NULL;
+    }
   } else {
-    Enesim_Buffer_Sw_Data sdata;
+    buffer = NULL;
+  }
 
-    sdata.xrgb8888.plane0_stride = GST_ROUND_UP_4 (thiz->w * 4);
-    sdata.xrgb8888.plane0 = (uint32_t *) GST_BUFFER_DATA (*buffer);
-    eb = enesim_buffer_new_data_from (ENESIM_BUFFER_FORMAT_XRGB8888, thiz->w,
-        thiz->h, EINA_FALSE, &sdata, NULL, NULL);
+  /* use our own buffers, recycled instead of allocated on every frame */
+  if (!buffer) {
+    buffer = gst_egueb_pool_buffer_get (thiz->pool, size);
+    gst_buffer_set_caps (buffer, GST_PAD_CAPS (GST_BASE_SRC_PAD (src)));
   }
 
-  /* convert it to a buffer and send it */
-  enesim_converter_surface (thiz->s, eb);
-  enesim_buffer_unref (eb);
+  return buffer;
 }
 
 static gboolean
-gst_egueb_svg_parse_naviation (GstEguebSrc * thiz, GstEvent * event)
+gst_egueb_src_zero_copy (GstEguebSrc * thiz)
 {
-  if (!thiz->input)
+  /* our xRGB and premultiplied ARGB caps match the memory layout of an
+   * ARGB8888 surface only on little endian machines
+   */
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+  if (!thiz->zero_copy)
     return FALSE;
+  return thiz->format == GST_VIDEO_FORMAT_BGRx ||
+      (thiz->format == GST_VIDEO_FORMAT_BGRA && thiz->premultiplied);
+#else
+  return FALSE;
+#endif
+}
 
-  switch (gst_navigation_event_get_type (event)) {
-    case GST_NAVIGATION_EVENT_INVALID:
-      break;
-    case GST_NAVIGATION_EVENT_KEY_PRESS:
-      break;
-    case GST_NAVIGATION_EVENT_KEY_RELEASE:
-      break;
-    case GST_NAVIGATION_EVENT_MOUSE_BUTTON_PRESS:
-      //esvg_element_svg_feed_mouse_down(thiz->e, 0);
-      break;
-    case GST_NAVIGATION_EVENT_MOUSE_BUTTON_RELEASE:
-      //esvg_element_svg_feed_mouse_up(thiz->e, 0);
-      break;
-    case GST_NAVIGATION_EVENT_MOUSE_MOVE:{
-        gdouble x;
-        gdouble y;
+static void
+gst_egueb_src_last_copy (GstEguebSrc * thiz, GstBuffer * buffer)
+{
+  memcpy (GST_BUFFER_DATA (buffer), GST_BUFFER_DATA (thiz->last),
+      MIN (GST_BUFFER_SIZE (buffer), GST_BUFFER_SIZE (thiz->last)));
+}
 
-        gst_navigation_event_parse_mouse_move_event (event, &x, &y);
-        GST_LOG_OBJECT (thiz, "Sending mouse at %g %g", x, y);
-	egueb_dom_input_feed_mouse_move(thiz->input, x, y);
-      }
-      break;
-    case GST_NAVIGATION_EVENT_COMMAND:
-      break;
+static GstBuffer *
+gst_egueb_src_last_repeat (GstEguebSrc * thiz)
+{
+  GstBuffer *buffer;
+
+  /* share the data with the last buffer, only the metadata changes */
+  buffer = gst_buffer_make_metadata_writable (gst_buffer_ref (thiz->last));
+  if (thiz->mark_repeated)
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
+  else
+    GST_BUFFER_FLAG_UNSET (buffer, GST_BUFFER_FLAG_GAP);
+
+  return buffer;
+}
+
+static void
+gst_egueb_src_last_set (GstEguebSrc * thiz, GstBuffer * buffer)
+{
+  if (thiz->last == buffer)
+    return;
+
+  if (thiz->last)
+    gst_buffer_unref (thiz->last);
+  thiz->last = gst_buffer_ref (buffer);
+}
+
+static Enesim_Surface *
+gst_egueb_src_surface_get (GstEguebSrc * thiz, GstBuffer * buffer)
+{
+  /* without a previous frame there is nothing to update the damages on */
+  if (!thiz->last)
+    thiz->damage_all = TRUE;
+
+  if (gst_egueb_src_zero_copy (thiz)) {
+    if (thiz->s) {
+      enesim_surface_unref (thiz->s);
+      thiz->s = NULL;
+    }
+
+    return enesim_surface_new_data_from (ENESIM_FORMAT_ARGB8888, thiz->w,
+        thiz->h, EINA_FALSE, GST_BUFFER_DATA (buffer),
+        GST_ROUND_UP_4 (thiz->w * 4), NULL, NULL);
   }
 
-  return TRUE;
+  if (!thiz->s) {
+    GST_DEBUG_OBJECT (thiz, "Creating surface of size %dx%d", thiz->w,
+        thiz->h);
+    thiz->s = enesim_surface_new (ENESIM_FORMAT_ARGB8888, thiz->w, thiz->h);
+    thiz->damage_all = TRUE;
+  }
+
+  return enesim_surface_ref (thiz->s);
 }
 
-/*----------------------------------------------------------------------------*
- *                           BaseSrc interface                                *
- *----------------------------------------------------------------------------*/
-static gboolean
-gst_egueb_src_event (GstBaseSrc * src, GstEvent * event)
+/* must be called with the document locked. The document is drawn on a
+ * smaller surface which is scaled up without any filtering
+ */
+static void
+gst_egueb_src_render_scaled (GstEguebSrc * thiz, Enesim_Surface * s,
+    Eina_List * damages, GstBuffer * buffer)
 {
-  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
-  gboolean ret = FALSE;
+  Enesim_Renderer *image;
+  Eina_List *small = NULL;
+  Eina_List *l;
+  Eina_Rectangle *area;
+  gint scale = thiz->scale;
+  gint sw, sh;
+
+  sw = (thiz->w + scale - 1) / scale;
+  sh = (thiz->h + scale - 1) / scale;
+  if (!thiz->small)
+    thiz->small = enesim_surface_new (ENESIM_FORMAT_ARGB8888, sw, sh);
+
+  EINA_LIST_FOREACH (damages, l, area) {
+    Eina_Rectangle r;
+    gint x1, y1;
+
+    x1 = MIN ((area->x + area->w + scale - 1) / scale, sw);
+    y1 = MIN ((area->y + area->h + scale - 1) / scale, sh);
+    eina_rectangle_coords_from (&r, area->x / scale, area->y / scale,
+        x1 - area->x / scale, y1 - area->y / scale);
+    small = gst_egueb_damages_append (small, &r);
+  }
 
-  GST_DEBUG_OBJECT (thiz, "event %s", GST_EVENT_TYPE_NAME (event));
-  switch (GST_EVENT_TYPE (event)) {
-    case GST_EVENT_QOS:{
-    GstQOSType type;
-    GstClockTimeDiff diff;
-    GstClockTime timestamp;
-    gdouble proportion;
-    gint fps_n;
-    gint fps_d;
-    gint fps;
+  if (gst_egueb_src_background_color_get (thiz) != 0) {
+    enesim_renderer_draw_list (thiz->background, thiz->small,
+        ENESIM_ROP_FILL, small, 0, 0, NULL);
+    gst_egueb_src_draw_document (thiz, thiz->small, ENESIM_ROP_BLEND, small);
+  } else {
+    gst_egueb_src_draw_document (thiz, thiz->small, ENESIM_ROP_FILL, small);
+  }
+  gst_egueb_damages_free (small);
+
+  image = enesim_renderer_image_new ();
+  enesim_renderer_image_source_surface_set (image,
+      enesim_surface_ref (thiz->small));
+  enesim_renderer_image_position_set (image, 0, 0);
+  enesim_renderer_image_size_set (image, sw * scale, sh * scale);
+  enesim_renderer_quality_set (image, ENESIM_QUALITY_FAST);
+  enesim_renderer_draw_list (image, s, ENESIM_ROP_FILL, damages, 0, 0, NULL);
+  enesim_renderer_unref (image);
+
+  if (buffer && !gst_egueb_src_zero_copy (thiz))
+    gst_egueb_converter_surface_list (s, thiz->format, thiz->premultiplied,
+        GST_BUFFER_DATA (buffer), damages);
+}
 
-    /* Whenever we receive a QoS we can decide to increase the fps
-     * on egueb and send more intermediate frames
-     */
-    gst_event_parse_qos_full (event, &type, &proportion, &diff, &timestamp);
-    fps_d = thiz->spf_n;
-    fps_n = thiz->spf_d;
+/* must be called with the document locked, without a buffer only the
+ * surface is drawn
+ */
+static void
+gst_egueb_src_render (GstEguebSrc * thiz, Enesim_Surface * s,
+    Eina_List * damages, GstBuffer * buffer)
+{
+  if (thiz->scale > 1) {
+    gst_egueb_src_render_scaled (thiz, s, damages, buffer);
+    return;
+  }
 
-    if (proportion > 1.0) {
-      fps_d = fps_d * proportion;
-    } else {
-      fps_n = fps_n + ((1 - proportion) * fps_n);
+  if (!thiz->coverage && gst_egueb_src_background_color_get (thiz) != 0)
+    gst_egueb_src_coverage_setup (thiz, s, damages);
+
+  gst_egueb_src_draw (thiz, s, damages,
+      gst_egueb_src_background_color_get (thiz) ? thiz->background : NULL);
+  /* in zero-copy mode there is nothing to convert */
+  if (buffer && !gst_egueb_src_zero_copy (thiz))
+    gst_egueb_converter_surface_list (s, thiz->format, thiz->premultiplied,
+        GST_BUFFER_DATA (buffer), damages);
+}
+
+static GstBuffer * gst_egueb_src_frame_get (GstEguebSrc * thiz);
+static void gst_egueb_src_renditions_render (GstEguebSrc * thiz,
+    Enesim_Surface * s, Eina_List * damages);
+static void gst_egueb_src_renditions_repeat (GstEguebSrc * thiz);
+
+/* A frame drawn by the render thread, waiting to be converted */
+typedef struct _GstEguebSrcFrame
+{
+  Enesim_Surface *s;
+  Eina_List *damages;
+  guint64 ts;
+  /* the stamps of the input events drawn on it */
+  GArray *inputs;
+} GstEguebSrcFrame;
+
+static void
+gst_egueb_src_frame_free (GstEguebSrcFrame * frame)
+{
+  if (frame->s)
+    enesim_surface_unref (frame->s);
+  gst_egueb_damages_free (frame->damages);
+  if (frame->inputs)
+    g_array_free (frame->inputs, TRUE);
+  g_free (frame);
+}
+
+/* the time of a number of frames at the negotiated framerate */
+static guint64
+gst_egueb_src_frames_time (GstEguebSrc * thiz, guint64 frames)
+{
+  if (!thiz->spf_d)
+    return 0;
+  return gst_util_uint64_scale (frames, (guint64) thiz->spf_n * GST_SECOND,
+      thiz->spf_d);
+}
+
+/* the timestamp of a frame counted from a base, on the segment rate */
+static guint64
+gst_egueb_src_position_at (GstEguebSrc * thiz, guint64 base, gint64 frame)
+{
+  gdouble rate = GST_BASE_SRC (thiz)->segment.rate;
+  gint64 offset;
+
+  offset = gst_egueb_src_frames_time (thiz, ABS (frame));
+  if (frame < 0)
+    offset = -offset;
+  if (rate != 1.0)
+    offset = rate * offset;
+  if (offset < 0 && (guint64) -offset > base)
+    return 0;
+  return base + offset;
+}
+
+static void
+gst_egueb_src_position_set (GstEguebSrc * thiz, guint64 ts)
+{
+  thiz->position_base = ts;
+  thiz->position_frame = 0;
+  thiz->last_ts = ts;
+}
+
+static void
+gst_egueb_src_position_advance (GstEguebSrc * thiz, gint64 frames)
+{
+  thiz->position_frame += frames;
+  thiz->last_ts = gst_egueb_src_position_at (thiz, thiz->position_base,
+      thiz->position_frame);
+}
+
+static GstEguebSrcFrame *
+gst_egueb_src_pipeline_render (GstEguebSrc * thiz)
+{
+  GstEguebSrcFrame *frame;
+  Enesim_Surface *s;
+  Eina_List *draw = NULL;
+  Eina_List *l;
+  Eina_Rectangle *r;
+
+  if (!thiz->surfaces[thiz->back]) {
+    Eina_Rectangle area;
+
+    GST_DEBUG_OBJECT (thiz, "Creating back surface of size %dx%d", thiz->w,
+        thiz->h);
+    thiz->surfaces[thiz->back] = enesim_surface_new (ENESIM_FORMAT_ARGB8888,
+        thiz->w, thiz->h);
+    /* a new surface lacks every previous frame */
+    eina_rectangle_coords_from (&area, 0, 0, thiz->w, thiz->h);
+    thiz->pending[thiz->back] = gst_egueb_damages_append (
+        thiz->pending[thiz->back], &area);
+  }
+  s = thiz->surfaces[thiz->back];
+
+  frame = g_new0 (GstEguebSrcFrame, 1);
+  frame->ts = thiz->render_ts;
+
+  g_mutex_lock (thiz->doc_lock);
+  gst_egueb_src_animation_time_set (thiz, frame->ts);
+  gst_egueb_src_process (thiz, s);
+  frame->damages = thiz->damages;
+  thiz->damages = NULL;
+  /* the input fed so far is on this frame */
+  if (thiz->input_applied->len) {
+    frame->inputs = thiz->input_applied;
+    thiz->input_applied = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  }
+
+  /* the back surface has the frame before the previous one, so it also
+   * needs the damages it missed
+   */
+  draw = thiz->pending[thiz->back];
+  thiz->pending[thiz->back] = NULL;
+  EINA_LIST_FOREACH (frame->damages, l, r) {
+    draw = gst_egueb_damages_append (draw, r);
+  }
+  if (draw) {
+    draw = gst_egueb_damages_coalesce (draw, thiz->damage_rect_cost);
+    gst_egueb_src_render (thiz, s, draw, NULL);
+    gst_egueb_damages_free (draw);
+  }
+  g_mutex_unlock (thiz->doc_lock);
+  thiz->render_frame++;
+  thiz->render_ts = gst_egueb_src_position_at (thiz, thiz->position_base,
+      thiz->render_frame);
+
+  /* a frame without damages is a repetition of the previous one, the
+   * front surface is left untouched
+   */
+  if (frame->damages) {
+    gint front = !thiz->back;
+
+    EINA_LIST_FOREACH (frame->damages, l, r) {
+      thiz->pending[front] = gst_egueb_damages_append (thiz->pending[front],
+          r);
     }
+    frame->s = enesim_surface_ref (s);
+    thiz->back = front;
+  }
+
+  return frame;
+}
 
-    fps = gst_util_uint64_scale (1, fps_n, fps_d);
-    if (fps < 1) fps = 1;
-    GST_DEBUG_OBJECT (thiz, "Updating framerate to %d/%d", fps_n, fps_d);
-    thiz->fps = fps;
-    egueb_smil_feature_animation_fps_set(thiz->animation, fps);
+static gpointer
+gst_egueb_src_pipeline_loop (gpointer data)
+{
+  GstEguebSrc *thiz = data;
+
+  GST_DEBUG_OBJECT (thiz, "Render thread started");
+  g_mutex_lock (thiz->pipeline_lock);
+  while (thiz->pipeline_running) {
+    GstEguebSrcFrame *frame;
+
+    /* Once the streaming thread takes the queued frame it is done with the
+     * surface of the previous one, which is our back surface
+     */
+    if (thiz->frame) {
+      g_cond_wait (thiz->pipeline_cond, thiz->pipeline_lock);
+      continue;
     }
-    break;
+    g_mutex_unlock (thiz->pipeline_lock);
 
-    case GST_EVENT_NAVIGATION:
-    g_mutex_lock (thiz->doc_lock);
-    ret = gst_egueb_svg_parse_naviation (thiz, event);
-    g_mutex_unlock (thiz->doc_lock);
-    break;
+    frame = gst_egueb_src_pipeline_render (thiz);
 
-    default:
-    break;
+    g_mutex_lock (thiz->pipeline_lock);
+    thiz->frame = frame;
+    g_cond_broadcast (thiz->pipeline_cond);
   }
+  g_mutex_unlock (thiz->pipeline_lock);
+  GST_DEBUG_OBJECT (thiz, "Render thread stopped");
 
-  /* pass to the base class */
-  if (!ret)
-    ret = GST_BASE_SRC_CLASS (parent_class)->event (src, event);
-
-  return ret;
+  return NULL;
 }
 
 static gboolean
-gst_egueb_src_query (GstBaseSrc * src, GstQuery * query)
+gst_egueb_src_pipeline_start (GstEguebSrc * thiz)
 {
-  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
-  gboolean ret = FALSE;
+  GError *err = NULL;
+
+  if (thiz->render_thread)
+    return TRUE;
+
+  /* the first frame must have everything */
+  thiz->damage_all = TRUE;
+  thiz->back = 0;
+  thiz->render_frame = thiz->position_frame;
+  thiz->render_ts = thiz->last_ts;
+  thiz->pipeline_running = TRUE;
+  thiz->render_thread = g_thread_create (gst_egueb_src_pipeline_loop, thiz,
+      TRUE, &err);
+  if (!thiz->render_thread) {
+    GST_ERROR_OBJECT (thiz, "Impossible to create the render thread: %s",
+        err->message);
+    g_error_free (err);
+    thiz->pipeline_running = FALSE;
+    return FALSE;
+  }
 
-  GST_DEBUG ("query %s", GST_QUERY_TYPE_NAME (query));
-  switch (GST_QUERY_TYPE (query)) {
-    case GST_QUERY_DURATION:
-    if (thiz->last_stop >= 0) {
-      gst_query_set_duration(query, GST_FORMAT_TIME, thiz->last_stop); 
-      ret = TRUE;
+  return TRUE;
+}
+
+static void
+gst_egueb_src_pipeline_stop (GstEguebSrc * thiz)
+{
+  gint i;
+
+  if (!thiz->render_thread)
+    return;
+
+  g_mutex_lock (thiz->pipeline_lock);
+  thiz->pipeline_running = FALSE;
+  g_cond_broadcast (thiz->pipeline_cond);
+  g_mutex_unlock (thiz->pipeline_lock);
+
+  g_thread_join (thiz->render_thread);
+  thiz->render_thread = NULL;
+
+  if (thiz->frame) {
+    gst_egueb_src_frame_free (thiz->frame);
+    thiz->frame = NULL;
+  }
+
+  for (i = 0; i < 2; i++) {
+    if (thiz->surfaces[i]) {
+      enesim_surface_unref (thiz->surfaces[i]);
+      thiz->surfaces[i] = NULL;
     }
-    break;
+    gst_egueb_damages_free (thiz->pending[i]);
+    thiz->pending[i] = NULL;
+  }
+}
+
+/* converts the next frame drawn by the render thread */
+static GstBuffer *
+gst_egueb_src_pipeline_frame_get (GstEguebSrc * thiz)
+{
+  GstEguebSrcFrame *frame;
+  GstBuffer *outbuf;
+
+  if (!gst_egueb_src_pipeline_start (thiz))
+    return NULL;
+
+  g_mutex_lock (thiz->pipeline_lock);
+  while (!thiz->frame && thiz->pipeline_running)
+    g_cond_wait (thiz->pipeline_cond, thiz->pipeline_lock);
+  frame = thiz->frame;
+  thiz->frame = NULL;
+  /* let the render thread start with the next frame */
+  g_cond_broadcast (thiz->pipeline_cond);
+  g_mutex_unlock (thiz->pipeline_lock);
+
+  if (!frame)
+    return NULL;
+
+  /* the frame sent instead has the input too */
+  if (frame->inputs)
+    g_array_append_vals (thiz->input_ready, frame->inputs->data,
+        frame->inputs->len);
+
+  if (!frame->damages && thiz->last) {
+    GST_LOG_OBJECT (thiz, "No damages, repeating the last frame");
+    outbuf = gst_egueb_src_last_repeat (thiz);
+    gst_egueb_src_renditions_repeat (thiz);
+  } else {
+    gint sw = 0, sh = 0;
+
+    outbuf = gst_egueb_src_buffer_get (thiz);
+    /* allocating can renegotiate, the frame was drawn at the old size */
+    if (frame->s)
+      enesim_surface_size_get (frame->s, &sw, &sh);
+    if (frame->s && (sw != thiz->w || sh != thiz->h)) {
+      GST_DEBUG_OBJECT (thiz, "Frame drawn at %dx%d instead of %dx%d, "
+          "drawing it again", sw, sh, thiz->w, thiz->h);
+      gst_buffer_unref (outbuf);
+      gst_egueb_src_frame_free (frame);
+      gst_egueb_src_pipeline_stop (thiz);
+      return gst_egueb_src_frame_get (thiz);
+    }
+    if (outbuf != thiz->last && thiz->last)
+      gst_egueb_src_last_copy (thiz, outbuf);
+    /* without a previous frame, like after a change of format, the
+     * surface has the whole frame
+     */
+    if (frame->s && !thiz->last)
+      gst_egueb_converter_surface_area (frame->s, thiz->format,
+          thiz->premultiplied, GST_BUFFER_DATA (outbuf), NULL);
+    else if (frame->s)
+      gst_egueb_converter_surface_list (frame->s, thiz->format,
+          thiz->premultiplied, GST_BUFFER_DATA (outbuf), frame->damages);
+    gst_egueb_src_last_set (thiz, outbuf);
+    gst_egueb_src_renditions_render (thiz, frame->s, frame->damages);
+  }
+  gst_egueb_src_frame_free (frame);
+
+  return outbuf;
+}
+
+static GstCaps * gst_egueb_src_get_caps (GstBaseSrc * src);
+static void gst_egueb_src_fixate (GstBaseSrc * src, GstCaps * caps);
+
+/* Another output of the same document at a different size, our own frames
+ * are scaled to it
+ */
+typedef struct _GstEguebSrcRendition
+{
+  GstPad *pad;
+  GstVideoFormat format;
+  gint w;
+  gint h;
+  Enesim_Surface *s;
+  Gst_Egueb_Pool *pool;
+  /* the frame to push */
+  GstBuffer *buffer;
+  /* the last drawn frame, pushed again while nothing changes */
+  GstBuffer *last;
+  gboolean need_segment;
+} GstEguebSrcRendition;
+
+static void
+gst_egueb_src_rendition_free (GstEguebSrcRendition * r)
+{
+  if (r->s)
+    enesim_surface_unref (r->s);
+  if (r->buffer)
+    gst_buffer_unref (r->buffer);
+  if (r->last)
+    gst_buffer_unref (r->last);
+  gst_egueb_pool_free (r->pool);
+  g_free (r);
+}
+
+/* the renditions are pushed at the same time as our own frames, so they
+ * can only have the framerate of our own pad. Whatever our viewport is, it
+ * is scaled to the size of the rendition
+ */
+static GstCaps *
+gst_egueb_src_rendition_get_caps (GstPad * pad)
+{
+  GstEguebSrc *thiz = GST_EGUEB_SRC (gst_pad_get_parent (pad));
+  const GValue *framerate = NULL;
+  GstCaps *caps;
+  GstCaps *main;
+  gint i;
+
+  caps = gst_egueb_src_get_caps (GST_BASE_SRC (thiz));
+  main = gst_pad_get_negotiated_caps (GST_BASE_SRC_PAD (thiz));
+  if (main)
+    framerate = gst_structure_get_value (gst_caps_get_structure (main, 0),
+        "framerate");
+
+  caps = gst_caps_make_writable (caps);
+  for (i = 0; i < gst_caps_get_size (caps); i++) {
+    GstStructure *s = gst_caps_get_structure (caps, i);
+
+    gst_structure_set (s,
+        "width", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+        "height", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+        NULL);
+    if (framerate)
+      gst_structure_set_value (s, "framerate", framerate);
+  }
+  if (main)
+    gst_caps_unref (main);
+  gst_object_unref (thiz);
+
+  return caps;
+}
+
+static gboolean
+gst_egueb_src_rendition_set_caps (GstPad * pad, GstCaps * caps)
+{
+  GstEguebSrcRendition *r = gst_pad_get_element_private (pad);
+  GstVideoFormat format;
+  gint width;
+  gint height;
+
+  if (!gst_video_format_parse_caps (caps, &format, &width, &height) ||
+      !gst_egueb_converter_format_supported (format)) {
+    GST_ERROR_OBJECT (pad, "Unsupported caps %" GST_PTR_FORMAT, caps);
+    return FALSE;
+  }
+
+  if (width != r->w || height != r->h) {
+    if (r->s) {
+      enesim_surface_unref (r->s);
+      r->s = NULL;
+    }
+    r->w = width;
+    r->h = height;
+  }
+  /* the last frame has the old caps */
+  if (r->last) {
+    gst_buffer_unref (r->last);
+    r->last = NULL;
+  }
+  r->format = format;
+  GST_INFO_OBJECT (pad, "Rendition of %dx%d", width, height);
+
+  return TRUE;
+}
+
+static gboolean
+gst_egueb_src_rendition_negotiate (GstEguebSrc * thiz,
+    GstEguebSrcRendition * r)
+{
+  GstCaps *caps;
+  GstCaps *peer;
+  gboolean ret;
+
+  if (GST_PAD_CAPS (r->pad))
+    return TRUE;
+
+  caps = gst_pad_get_caps (r->pad);
+  peer = gst_pad_peer_get_caps (r->pad);
+  if (peer) {
+    GstCaps *icaps;
+
+    icaps = gst_caps_intersect (caps, peer);
+    gst_caps_unref (caps);
+    gst_caps_unref (peer);
+    caps = icaps;
+  }
+
+  if (gst_caps_is_empty (caps)) {
+    GST_WARNING_OBJECT (r->pad, "No common caps with downstream");
+    gst_caps_unref (caps);
+    return FALSE;
+  }
+
+  caps = gst_caps_make_writable (caps);
+  gst_caps_truncate (caps);
+  gst_egueb_src_fixate (GST_BASE_SRC (thiz), caps);
+  ret = gst_pad_set_caps (r->pad, caps);
+  gst_caps_unref (caps);
+
+  return ret;
+}
+
+/* same as gst_egueb_src_buffer_get but for a rendition */
+static GstBuffer *
+gst_egueb_src_rendition_buffer_get (GstEguebSrcRendition * r)
+{
+  GstBuffer *buffer = NULL;
+  GstFlowReturn ret;
+  gint size;
+
+  if (r->last && gst_buffer_is_writable (r->last))
+    return gst_buffer_ref (r->last);
+
+  size = gst_video_format_get_size (r->format, r->w, r->h);
+  ret = gst_pad_alloc_buffer_and_set_caps (r->pad, GST_BUFFER_OFFSET_NONE,
+      size, GST_PAD_CAPS (r->pad), &buffer);
+  if (ret == GST_FLOW_OK) {
+    /* the caps might have changed */
+    size = gst_video_format_get_size (r->format, r->w, r->h);
+    if (GST_BUFFER_SIZE (buffer) != size) {
+      gst_buffer_unref (buffer);
+      buffer = NULL;
+    }
+  } else {
+    buffer = NULL;
+  }
+
+  if (!buffer) {
+    buffer = gst_egueb_pool_buffer_get (r->pool, size);
+    gst_buffer_set_caps (buffer, GST_PAD_CAPS (r->pad));
+  }
+
+  return buffer;
+}
+
+static GstBuffer *
+gst_egueb_src_rendition_last_repeat (GstEguebSrc * thiz,
+    GstEguebSrcRendition * r)
+{
+  GstBuffer *buffer;
+
+  buffer = gst_buffer_make_metadata_writable (gst_buffer_ref (r->last));
+  if (thiz->mark_repeated)
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
+  else
+    GST_BUFFER_FLAG_UNSET (buffer, GST_BUFFER_FLAG_GAP);
+
+  return buffer;
+}
+
+/* The damages of our own frame on the rendition. The scaling filters the
+ * pixels around, so the damages grow one pixel on every side
+ */
+static Eina_List *
+gst_egueb_src_rendition_damages_get (GstEguebSrc * thiz,
+    GstEguebSrcRendition * r, Eina_List * damages)
+{
+  Eina_List *scaled = NULL;
+  Eina_List *l;
+  Eina_Rectangle *area;
+
+  EINA_LIST_FOREACH (damages, l, area) {
+    Eina_Rectangle d;
+    gint64 x0, y0, x1, y1;
+
+    x0 = (gint64) MAX (area->x - 1, 0) * r->w / thiz->w;
+    y0 = (gint64) MAX (area->y - 1, 0) * r->h / thiz->h;
+    x1 = ((gint64) (area->x + area->w + 1) * r->w + thiz->w - 1) / thiz->w;
+    y1 = ((gint64) (area->y + area->h + 1) * r->h + thiz->h - 1) / thiz->h;
+    eina_rectangle_coords_from (&d, x0, y0, MIN (x1, r->w) - x0,
+        MIN (y1, r->h) - y0);
+    scaled = gst_egueb_damages_append (scaled, &d);
+  }
+
+  return scaled;
+}
+
+/* Scales the damages of our own surface on the buffer of the rendition.
+ * Without a previous frame, or without damages, the whole frame is scaled
+ */
+static void
+gst_egueb_src_rendition_draw (GstEguebSrc * thiz, GstEguebSrcRendition * r,
+    Enesim_Surface * s, Eina_List * damages)
+{
+  Enesim_Renderer *image;
+  Eina_List *areas;
+
+  if (!r->s)
+    r->s = enesim_surface_new (ENESIM_FORMAT_ARGB8888, r->w, r->h);
+
+  if (r->last && damages) {
+    areas = gst_egueb_src_rendition_damages_get (thiz, r, damages);
+    if (r->buffer != r->last)
+      memcpy (GST_BUFFER_DATA (r->buffer), GST_BUFFER_DATA (r->last),
+          MIN (GST_BUFFER_SIZE (r->buffer), GST_BUFFER_SIZE (r->last)));
+  } else {
+    Eina_Rectangle area;
+
+    eina_rectangle_coords_from (&area, 0, 0, r->w, r->h);
+    areas = gst_egueb_damages_append (NULL, &area);
+  }
+
+  image = enesim_renderer_image_new ();
+  enesim_renderer_image_source_surface_set (image, enesim_surface_ref (s));
+  enesim_renderer_image_position_set (image, 0, 0);
+  enesim_renderer_image_size_set (image, r->w, r->h);
+  enesim_renderer_draw_list (image, r->s, ENESIM_ROP_FILL, areas, 0, 0,
+      NULL);
+  enesim_renderer_unref (image);
+
+  gst_egueb_converter_surface_list (r->s, r->format, thiz->premultiplied,
+      GST_BUFFER_DATA (r->buffer), areas);
+  gst_egueb_damages_free (areas);
+  GST_BUFFER_FLAG_UNSET (r->buffer, GST_BUFFER_FLAG_GAP);
+}
+
+/* The renditions follow every frame of our own pad. The damages drawn on
+ * our surface are scaled to them, so the document is laid out and drawn
+ * only once. Without damages our own frame is repeated and so are the
+ * renditions, a rendition without a frame yet takes the whole surface if
+ * there is one
+ */
+static void
+gst_egueb_src_renditions_render (GstEguebSrc * thiz, Enesim_Surface * s,
+    Eina_List * damages)
+{
+  GList *l;
+
+  for (l = thiz->renditions; l; l = g_list_next (l)) {
+    GstEguebSrcRendition *r = l->data;
+
+    if (!gst_pad_is_linked (r->pad) ||
+        !gst_egueb_src_rendition_negotiate (thiz, r))
+      continue;
+
+    if (r->last && !damages) {
+      r->buffer = gst_egueb_src_rendition_last_repeat (thiz, r);
+      continue;
+    }
+    if (!s)
+      continue;
+
+    r->buffer = gst_egueb_src_rendition_buffer_get (r);
+    gst_egueb_src_rendition_draw (thiz, r, s, damages);
+    if (r->last)
+      gst_buffer_unref (r->last);
+    r->last = gst_buffer_ref (r->buffer);
+  }
+}
+
+/* our own frame is repeated, our surface has it unless the render thread
+ * draws the frames
+ */
+static void
+gst_egueb_src_renditions_repeat (GstEguebSrc * thiz)
+{
+  gst_egueb_src_renditions_render (thiz,
+      thiz->render_thread ? NULL : thiz->s, NULL);
+}
+
+static void
+gst_egueb_src_renditions_push (GstEguebSrc * thiz, GstClockTime ts,
+    GstClockTime duration)
+{
+  GList *l;
+
+  for (l = thiz->renditions; l; l = g_list_next (l)) {
+    GstEguebSrcRendition *r = l->data;
+    GstBuffer *buffer = r->buffer;
+    GstFlowReturn ret;
+
+    if (!buffer)
+      continue;
+    r->buffer = NULL;
+
+    /* the same segment as our own pad, starting at this frame */
+    if (r->need_segment) {
+      GstSegment *segment = &GST_BASE_SRC (thiz)->segment;
+      gint64 start = ts;
+      gint64 stop = segment->stop;
+
+      if (segment->rate < 0) {
+        start = segment->start;
+        stop = GST_CLOCK_TIME_IS_VALID (duration) ? ts + duration : ts;
+      }
+      gst_pad_push_event (r->pad, gst_event_new_new_segment_full (FALSE,
+          segment->rate, segment->applied_rate, GST_FORMAT_TIME, start,
+          stop, gst_segment_to_stream_time (segment, GST_FORMAT_TIME,
+          start)));
+      r->need_segment = FALSE;
+    }
+
+    GST_BUFFER_TIMESTAMP (buffer) = ts;
+    GST_BUFFER_DURATION (buffer) = duration;
+    ret = gst_pad_push (r->pad, buffer);
+    if (ret != GST_FLOW_OK)
+      GST_DEBUG_OBJECT (r->pad, "Pushing failed: %s",
+          gst_flow_get_name (ret));
+  }
+}
+
+static void
+gst_egueb_src_renditions_push_event (GstEguebSrc * thiz, GstEvent * event)
+{
+  GList *l;
+
+  for (l = thiz->renditions; l; l = g_list_next (l)) {
+    GstEguebSrcRendition *r = l->data;
+
+    gst_pad_push_event (r->pad, gst_event_ref (event));
+  }
+  gst_event_unref (event);
+}
+
+/* processes, draws and converts the next frame */
+static GstBuffer *
+gst_egueb_src_frame_get (GstEguebSrc * thiz)
+{
+  GstBuffer *outbuf = NULL;
+  Enesim_Surface *s;
+  Eina_Bool damaged;
+  gboolean drawn = TRUE;
+
+  /* in zero-copy mode the document is rendered on the buffer itself */
+  if (gst_egueb_src_zero_copy (thiz))
+    outbuf = gst_egueb_src_buffer_get (thiz);
+  s = gst_egueb_src_surface_get (thiz, outbuf);
+
+  g_mutex_lock (thiz->doc_lock);
+  gst_egueb_src_animation_time_set (thiz, thiz->last_ts);
+  damaged = gst_egueb_src_process (thiz, s);
+  /* the input fed so far is on this frame */
+  g_array_append_vals (thiz->input_ready, thiz->input_applied->data,
+      thiz->input_applied->len);
+  g_array_set_size (thiz->input_applied, 0);
+  if (!damaged && thiz->last) {
+    /* nothing has changed, push the previous frame again */
+    GST_LOG_OBJECT (thiz, "No damages, repeating the last frame");
+    if (outbuf)
+      gst_buffer_unref (outbuf);
+    outbuf = gst_egueb_src_last_repeat (thiz);
+    g_mutex_unlock (thiz->doc_lock);
+    drawn = FALSE;
+  } else {
+    if (!outbuf) {
+      /* allocating can renegotiate, which needs the document */
+      g_mutex_unlock (thiz->doc_lock);
+      outbuf = gst_egueb_src_buffer_get (thiz);
+      g_mutex_lock (thiz->doc_lock);
+      /* downstream has renegotiated the size, start again */
+      if (s != thiz->s) {
+        enesim_surface_unref (s);
+        s = gst_egueb_src_surface_get (thiz, outbuf);
+        gst_egueb_src_process (thiz, s);
+      } else if (!thiz->last) {
+        /* only the format has changed, the buffer has nothing yet */
+        thiz->damage_all = TRUE;
+        gst_egueb_src_process (thiz, s);
+      }
+    }
+    /* only the damages are updated on top of the previous frame */
+    if (outbuf != thiz->last && thiz->last)
+      gst_egueb_src_last_copy (thiz, outbuf);
+    gst_egueb_src_render (thiz, s, thiz->damages, outbuf);
+    g_mutex_unlock (thiz->doc_lock);
+    gst_egueb_src_last_set (thiz, outbuf);
+  }
+
+  if (drawn)
+    gst_egueb_src_renditions_render (thiz, s, thiz->damages);
+  else
+    gst_egueb_src_renditions_repeat (thiz);
+  enesim_surface_unref (s);
+  gst_egueb_src_damages_clear (thiz);
+
+  thiz->last_drawn = drawn;
+
+  return outbuf;
+}
+
+/* The number of the next frame inside the loop period, only whole frames
+ * repeat on every period. The timestamps are rounded to the nanosecond, so
+ * they are compared within a tolerance
+ */
+static gboolean
+gst_egueb_src_cache_frame (GstEguebSrc * thiz, guint * frame)
+{
+  guint64 frames;
+  guint64 index;
+  guint64 pos;
+  guint64 at;
+
+  if (!thiz->loop_period || !thiz->animation || thiz->renditions ||
+      thiz->duration <= 0)
+    return FALSE;
+
+  frames = gst_util_uint64_scale_round (thiz->loop_period, thiz->spf_d,
+      (guint64) thiz->spf_n * GST_SECOND);
+  at = gst_egueb_src_frames_time (thiz, frames);
+  if (!frames || ABS ((gint64) (at - thiz->loop_period)) >
+      CACHE_FRAME_TOLERANCE) {
+    GST_LOG_OBJECT (thiz, "The loop period is not a whole number of frames");
+    return FALSE;
+  }
+
+  /* other rates or seeks can put the frame in between */
+  pos = thiz->last_ts % thiz->loop_period;
+  index = gst_util_uint64_scale_round (pos, thiz->spf_d,
+      (guint64) thiz->spf_n * GST_SECOND);
+  at = gst_egueb_src_frames_time (thiz, index);
+  if (ABS ((gint64) (at - pos)) > CACHE_FRAME_TOLERANCE)
+    return FALSE;
+
+  *frame = index % frames;
+  return TRUE;
+}
+
+/* The frames on the cache directory are valid only while the document
+ * follows its timeline from the beginning
+ */
+static gboolean
+gst_egueb_src_store_ready (GstEguebSrc * thiz)
+{
+  GstPad *pad = GST_BASE_SRC_PAD (thiz);
+  gchar *caps;
+  gchar *description;
+
+  if (!thiz->store || thiz->diverged || !thiz->animation || thiz->renditions)
+    return FALSE;
+
+  if (!GST_PAD_CAPS (pad))
+    return FALSE;
+
+  /* everything that changes the content of the frames */
+  if (thiz->store_dirty) {
+    caps = gst_caps_to_string (GST_PAD_CAPS (pad));
+    description = g_strdup_printf ("%s background=%08x premultiplied=%d "
+        "viewport=%d,%d,%d", caps,
+        enesim_renderer_background_color_get (thiz->background),
+        thiz->premultiplied, thiz->roi, thiz->roi_x, thiz->roi_y);
+    gst_egueb_store_document_set (thiz->store, thiz->xml, thiz->location,
+        description);
+    g_free (description);
+    g_free (caps);
+    thiz->store_dirty = FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Same as gst_egueb_src_frame_get but the frames of a looping document are
+ * taken from the cache once a whole period has been rendered, and the frames
+ * rendered on previous runs from the cache directory. The document is not
+ * touched, whatever has changed since the last frame drawn is drawn on the
+ * next frame not in the cache. The renditions are scaled from the frames
+ * drawn, with them every frame is drawn
+ */
+static GstBuffer *
+gst_egueb_src_cache_frame_get (GstEguebSrc * thiz)
+{
+  GstBuffer *outbuf = NULL;
+  gboolean cached;
+  gboolean stored;
+  guint frame;
+
+  cached = gst_egueb_src_cache_frame (thiz, &frame);
+  stored = gst_egueb_src_store_ready (thiz);
+  if (!cached && !stored)
+    return gst_egueb_src_frame_get (thiz);
+
+  if (cached) {
+    outbuf = gst_egueb_cache_get (thiz->cache, frame);
+    GST_OBJECT_LOCK (thiz);
+    if (outbuf)
+      thiz->cache_hits++;
+    else
+      thiz->cache_misses++;
+    GST_OBJECT_UNLOCK (thiz);
+  }
+
+  if (!outbuf && stored) {
+    outbuf = gst_egueb_store_get (thiz->store, thiz->last_ts);
+    if (outbuf) {
+      GST_LOG_OBJECT (thiz, "Using the stored frame at %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (thiz->last_ts));
+      gst_buffer_set_caps (outbuf, GST_PAD_CAPS (GST_BASE_SRC_PAD (thiz)));
+      if (cached)
+        gst_egueb_cache_add (thiz->cache, frame, outbuf);
+    }
+  }
+
+  if (outbuf) {
+    GST_LOG_OBJECT (thiz, "Using a cached frame");
+    /* only the metadata changes */
+    outbuf = gst_buffer_make_metadata_writable (outbuf);
+    GST_BUFFER_FLAG_UNSET (outbuf, GST_BUFFER_FLAG_GAP);
+    return outbuf;
+  }
+
+  outbuf = gst_egueb_src_frame_get (thiz);
+  /* a degraded frame must not replace the real one */
+  if (thiz->scale > 1)
+    return outbuf;
+  if (cached)
+    gst_egueb_cache_add (thiz->cache, frame, outbuf);
+  /* a repeated frame is cheap to get again, do not fill the directory
+   * with copies of it
+   */
+  if (stored && thiz->last_drawn)
+    gst_egueb_store_add (thiz->store, thiz->last_ts, outbuf);
+
+  return outbuf;
+}
+
+/* The events are only queued here, the document is fed with them by the
+ * streaming thread before drawing the next frame
+ */
+static gboolean
+gst_egueb_svg_parse_naviation (GstEguebSrc * thiz, GstEvent * event)
+{
+  Gst_Egueb_Navigation_Event ev = { 0, };
+  const gchar *key;
+
+  if (!thiz->input)
+    return FALSE;
+
+  switch (gst_navigation_event_get_type (event)) {
+    case GST_NAVIGATION_EVENT_KEY_PRESS:
+    case GST_NAVIGATION_EVENT_KEY_RELEASE:
+      if (!gst_navigation_event_parse_key_event (event, &key) || !key)
+        return FALSE;
+      ev.type = gst_navigation_event_get_type (event) ==
+          GST_NAVIGATION_EVENT_KEY_PRESS ? GST_EGUEB_NAVIGATION_KEY_DOWN :
+          GST_EGUEB_NAVIGATION_KEY_UP;
+      g_strlcpy (ev.key, key, sizeof (ev.key));
+      break;
+    case GST_NAVIGATION_EVENT_MOUSE_BUTTON_PRESS:
+    case GST_NAVIGATION_EVENT_MOUSE_BUTTON_RELEASE:
+      if (!gst_navigation_event_parse_mouse_button_event (event, &ev.button,
+          &ev.x, &ev.y))
+        return FALSE;
+      ev.type = gst_navigation_event_get_type (event) ==
+          GST_NAVIGATION_EVENT_MOUSE_BUTTON_PRESS ?
+          GST_EGUEB_NAVIGATION_MOUSE_DOWN : GST_EGUEB_NAVIGATION_MOUSE_UP;
+      break;
+    case GST_NAVIGATION_EVENT_MOUSE_MOVE:
+      if (!gst_navigation_event_parse_mouse_move_event (event, &ev.x, &ev.y))
+        return FALSE;
+      ev.type = GST_EGUEB_NAVIGATION_MOUSE_MOVE;
+      break;
+    default:
+      return FALSE;
+  }
+
+  ev.stamp = gst_util_get_timestamp ();
+  gst_egueb_navigation_push (thiz->navigation, &ev);
+  return TRUE;
+}
+
+/* the names of the X keys that differ from the DOM key values */
+static const gchar *
+gst_egueb_src_key_name (const gchar * key)
+{
+  static const gchar *keys[][2] = {
+    { "Return", "Enter" },
+    { "KP_Enter", "Enter" },
+    { "Left", "ArrowLeft" },
+    { "Right", "ArrowRight" },
+    { "Up", "ArrowUp" },
+    { "Down", "ArrowDown" },
+    { "Prior", "PageUp" },
+    { "Next", "PageDown" },
+    { "BackSpace", "Backspace" },
+    { "space", " " },
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (keys); i++) {
+    if (!strcmp (key, keys[i][0]))
+      return keys[i][1];
+  }
+  return key;
+}
+
+/* called with the document locked */
+static void
+gst_egueb_src_navigation_feed (Gst_Egueb_Navigation_Event * ev,
+    const GstClockTime * stamps, guint count, gpointer data)
+{
+  GstEguebSrc *thiz = data;
+  Egueb_Dom_String *key;
+  gint x, y;
+
+  /* the merged moves are counted too */
+  g_array_append_vals (thiz->input_applied, stamps, count);
+  switch (ev->type) {
+    case GST_EGUEB_NAVIGATION_MOUSE_MOVE:
+    /* from the output frame to the document */
+    x = (ev->x + thiz->roi_x) / thiz->scale;
+    y = (ev->y + thiz->roi_y) / thiz->scale;
+    GST_LOG_OBJECT (thiz, "Sending mouse at %d %d", x, y);
+    egueb_dom_input_feed_mouse_move (thiz->input, x, y);
+    break;
+
+    /* the GStreamer buttons start at 1, the DOM ones at 0 */
+    case GST_EGUEB_NAVIGATION_MOUSE_DOWN:
+    GST_LOG_OBJECT (thiz, "Sending mouse button %d down", ev->button);
+    egueb_dom_input_feed_mouse_down (thiz->input, MAX (ev->button - 1, 0));
+    break;
+
+    case GST_EGUEB_NAVIGATION_MOUSE_UP:
+    GST_LOG_OBJECT (thiz, "Sending mouse button %d up", ev->button);
+    egueb_dom_input_feed_mouse_up (thiz->input, MAX (ev->button - 1, 0));
+    break;
+
+    /* the input owns the key string */
+    case GST_EGUEB_NAVIGATION_KEY_DOWN:
+    GST_LOG_OBJECT (thiz, "Sending key %s down", ev->key);
+    key = egueb_dom_string_new_with_string (gst_egueb_src_key_name (ev->key));
+    egueb_dom_input_feed_key_down (thiz->input, key,
+        EGUEB_DOM_KEY_LOCATION_STANDARD, EINA_FALSE, EINA_FALSE, EINA_FALSE,
+        EINA_FALSE);
+    break;
+
+    case GST_EGUEB_NAVIGATION_KEY_UP:
+    GST_LOG_OBJECT (thiz, "Sending key %s up", ev->key);
+    key = egueb_dom_string_new_with_string (gst_egueb_src_key_name (ev->key));
+    egueb_dom_input_feed_key_up (thiz->input, key,
+        EGUEB_DOM_KEY_LOCATION_STANDARD, EINA_FALSE, EINA_FALSE, EINA_FALSE,
+        EINA_FALSE);
+    break;
+  }
+}
+
+/* Feeds the document with the queued input events, returns whether any
+ * event has been given
+ */
+static gboolean
+gst_egueb_src_navigation_apply (GstEguebSrc * thiz)
+{
+  guint count;
+
+  if (!thiz->input)
+    return FALSE;
+
+  /* the still image does not need to wait for what is drained here */
+  GST_OBJECT_LOCK (thiz);
+  thiz->still_wake = FALSE;
+  GST_OBJECT_UNLOCK (thiz);
+
+  g_mutex_lock (thiz->doc_lock);
+  count = gst_egueb_navigation_drain (thiz->navigation,
+      gst_egueb_src_navigation_feed, thiz);
+  g_mutex_unlock (thiz->doc_lock);
+  if (!count)
+    return FALSE;
+
+  /* the interaction makes the document differ from the cached period */
+  gst_egueb_cache_flush (thiz->cache);
+  thiz->diverged = TRUE;
+
+  return TRUE;
+}
+
+/*----------------------------------------------------------------------------*
+ *                           BaseSrc interface                                *
+ *----------------------------------------------------------------------------*/
+static gboolean
+gst_egueb_src_event (GstBaseSrc * src, GstEvent * event)
+{
+  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
+  gboolean ret = FALSE;
+
+  GST_DEBUG_OBJECT (thiz, "event %s", GST_EVENT_TYPE_NAME (event));
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_QOS:{
+    GstQOSType type;
+    GstClockTimeDiff diff;
+    GstClockTime timestamp;
+    gdouble proportion;
+    Gst_Egueb_Qos_Level level;
+    gboolean changed;
+
+    /* Whenever downstream is late we degrade the quality of the frames,
+     * the streaming thread takes the new level on the next frame
+     */
+    gst_event_parse_qos_full (event, &type, &proportion, &diff, &timestamp);
+    GST_OBJECT_LOCK (thiz);
+    changed = gst_egueb_qos_update (thiz->qos, proportion, diff);
+    level = gst_egueb_qos_level_get (thiz->qos);
+    /* when late, leave room for the frames that are still on their way */
+    if (diff > 0)
+      thiz->earliest = timestamp + 2 * diff + thiz->duration;
+    else
+      thiz->earliest = timestamp + diff;
+    GST_OBJECT_UNLOCK (thiz);
+
+    if (changed) {
+      GST_INFO_OBJECT (thiz, "QoS level is now %d", level);
+      g_object_notify (G_OBJECT (thiz), "qos-level");
+      gst_element_post_message (GST_ELEMENT (thiz),
+          gst_message_new_element (GST_OBJECT (thiz),
+              gst_structure_new ("egueb-qos",
+                  "level", G_TYPE_UINT, level,
+                  "proportion", G_TYPE_DOUBLE, proportion,
+                  "jitter", G_TYPE_INT64, diff,
+                  NULL)));
+    }
+    }
+    break;
+
+    case GST_EVENT_STEP:{
+    gdouble rate;
+
+    /* the frames after the step are pushed at the rate of the segment */
+    gst_event_parse_step (event, NULL, NULL, &rate, NULL, NULL);
+    if (rate != 1.0) {
+      GST_WARNING_OBJECT (thiz, "Stepping at a rate of %g is not "
+          "supported", rate);
+      break;
+    }
+    GST_OBJECT_LOCK (thiz);
+    if (thiz->step)
+      gst_event_unref (thiz->step);
+    thiz->step = gst_event_ref (event);
+    GST_OBJECT_UNLOCK (thiz);
+    ret = TRUE;
+    }
+    break;
+
+    case GST_EVENT_LATENCY:{
+    GstClockTime latency;
+
+    gst_event_parse_latency (event, &latency);
+    GST_DEBUG_OBJECT (thiz, "Pipeline latency is %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (latency));
+    GST_OBJECT_LOCK (thiz);
+    thiz->latency_configured = latency;
+    GST_OBJECT_UNLOCK (thiz);
+    }
+    break;
+
+    case GST_EVENT_NAVIGATION:
+    ret = gst_egueb_svg_parse_naviation (thiz, event);
+    /* a still image waits for the input */
+    if (ret) {
+      GST_OBJECT_LOCK (thiz);
+      thiz->still_wake = TRUE;
+      g_cond_broadcast (thiz->still_cond);
+      GST_OBJECT_UNLOCK (thiz);
+    }
+    break;
+
+    default:
+    break;
+  }
+
+  /* pass to the base class */
+  if (!ret)
+    ret = GST_BASE_SRC_CLASS (parent_class)->event (src, event);
+
+  return ret;
+}
+
+/* The latency reported, until enough frames have been drawn a whole frame
+ * is assumed
+ */
+static GstClockTime
+gst_egueb_src_latency_get (GstEguebSrc * thiz)
+{
+  GstClockTime latency;
+
+  GST_OBJECT_LOCK (thiz);
+  latency = thiz->latency_reported;
+  GST_OBJECT_UNLOCK (thiz);
+  if (!GST_CLOCK_TIME_IS_VALID (latency))
+    latency = thiz->duration > 0 ? thiz->duration : 0;
+
+  return latency;
+}
+
+/* Keeps the time spent on a frame, the pipeline is informed whenever the
+ * latency must grow or can be much smaller. Sorting the samples is not
+ * done on every frame
+ */
+static void
+gst_egueb_src_latency_add (GstEguebSrc * thiz, GstClockTime sample)
+{
+  GstClockTime latency = 0;
+  GstClockTime reported;
+  gboolean update = FALSE;
+
+  GST_OBJECT_LOCK (thiz);
+  gst_egueb_latency_add (thiz->latency, sample);
+  thiz->latency_samples++;
+  if (gst_egueb_latency_count_get (thiz->latency) >= LATENCY_MIN_SAMPLES &&
+      thiz->latency_samples >= LATENCY_UPDATE_SAMPLES) {
+    thiz->latency_samples = 0;
+    latency = gst_egueb_latency_percentile_get (thiz->latency,
+        LATENCY_PERCENTILE);
+    reported = thiz->latency_reported;
+    if (!GST_CLOCK_TIME_IS_VALID (reported) || latency > reported ||
+        latency < reported / 2) {
+      thiz->latency_reported = latency;
+      update = TRUE;
+    }
+  }
+  GST_OBJECT_UNLOCK (thiz);
+
+  if (update && gst_base_src_is_live (GST_BASE_SRC (thiz))) {
+    GST_INFO_OBJECT (thiz, "Render latency is now %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (latency));
+    gst_element_post_message (GST_ELEMENT (thiz),
+        gst_message_new_latency (GST_OBJECT (thiz)));
+  }
+}
+
+static gboolean
+gst_egueb_src_query (GstBaseSrc * src, GstQuery * query)
+{
+  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
+  gboolean ret = FALSE;
+
+  GST_DEBUG ("query %s", GST_QUERY_TYPE_NAME (query));
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_DURATION:
+    if (thiz->last_stop >= 0) {
+      gst_query_set_duration(query, GST_FORMAT_TIME, thiz->last_stop); 
+      ret = TRUE;
+    }
+    break;
+
+    /* a frame is ready once it has been drawn after its running time */
+    case GST_QUERY_LATENCY:
+    if (gst_base_src_is_live (src)) {
+      GstClockTime latency;
+
+      latency = gst_egueb_src_latency_get (thiz);
+      GST_DEBUG_OBJECT (thiz, "Reporting a latency of %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (latency));
+      /* the frames are drawn when asked for, we can wait for any other
+       * source as long as needed
+       */
+      gst_query_set_latency (query, TRUE, latency, GST_CLOCK_TIME_NONE);
+      ret = TRUE;
+    }
+    break;
+
+    default:
+    break;
+  }
+
+  if (!ret)
+    ret = GST_BASE_SRC_CLASS (parent_class)->query (src, query);
+
+  return ret;
+}
+
+static gboolean
+gst_egueb_src_prepare_seek_segment (GstBaseSrc *src, GstEvent *seek,
+    GstSegment *segment)
+{
+  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
+  GstSeekFlags flags;
+  GstSeekType cur_type, stop_type;
+  GstFormat format;
+  gint64 cur, stop;
+  gdouble rate;
+  gboolean update;
+
+  gst_event_parse_seek (seek, &rate, &format, &flags, &cur_type, &cur,
+      &stop_type, &stop);
+  if (format != GST_FORMAT_TIME) {
+    GST_DEBUG_OBJECT (thiz, "Can only seek on time");
+    return FALSE;
+  }
+
+  /* every frame is a keyframe, snapping just puts the start on the
+   * timestamp of a frame. The frame is counted at the negotiated rate,
+   * the rounded duration drifts away from the frames on long seeks
+   */
+  if ((thiz->seek_snap || (flags & GST_SEEK_FLAG_KEY_UNIT)) &&
+      cur_type == GST_SEEK_TYPE_SET && cur > 0 && thiz->duration > 0) {
+    guint64 frame;
+    gint64 snapped;
+
+    frame = gst_util_uint64_scale_round (cur, thiz->spf_d,
+        (guint64) thiz->spf_n * GST_SECOND);
+    snapped = gst_egueb_src_frames_time (thiz, frame);
+    GST_DEBUG_OBJECT (thiz, "Snapping %" GST_TIME_FORMAT " to %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (cur), GST_TIME_ARGS (snapped));
+    cur = snapped;
+  }
+
+  thiz->seek_flush = (flags & GST_SEEK_FLAG_FLUSH) != 0;
+  gst_segment_set_seek (segment, rate, format, flags, cur_type, cur,
+      stop_type, stop, &update);
+
+  return TRUE;
+}
+
+/* called with the streaming thread stopped, the time of the document is
+ * set once the next frame is created
+ */
+static gboolean
+gst_egueb_src_do_seek (GstBaseSrc *src, GstSegment *segment)
+{
+  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
+  GList *l;
+
+  GST_DEBUG_OBJECT (src, "do seek at %" GST_TIME_FORMAT, GST_TIME_ARGS (segment->start));
+  /* the render thread is ahead of the new position */
+  gst_egueb_src_pipeline_stop (thiz);
+  thiz->seek = segment->start;
+  thiz->segment_done = FALSE;
+  thiz->frame_sent = FALSE;
+  GST_OBJECT_LOCK (thiz);
+  thiz->earliest = GST_CLOCK_TIME_NONE;
+  GST_OBJECT_UNLOCK (thiz);
+  /* backwards from the end, the last frame is the one before it */
+  if (segment->rate < 0) {
+    gint64 end = segment->stop;
+
+    if (end < 0)
+      end = thiz->last_stop;
+    if (end > segment->start + thiz->duration)
+      thiz->seek = end - thiz->duration;
+  }
+
+  for (l = thiz->renditions; l; l = g_list_next (l)) {
+    GstEguebSrcRendition *r = l->data;
+
+    if (thiz->seek_flush) {
+      gst_pad_push_event (r->pad, gst_event_new_flush_start ());
+      gst_pad_push_event (r->pad, gst_event_new_flush_stop ());
+    }
+    r->need_segment = TRUE;
+  }
+  thiz->seek_flush = FALSE;
+
+  return TRUE;
+}
+
+/* Jump directly to the new time, no matter how far it is. The document is
+ * set at the time of every frame when drawing it
+ */
+static void
+gst_egueb_src_seek_apply (GstEguebSrc * thiz)
+{
+  GST_DEBUG_OBJECT (thiz, "Setting the time to %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (thiz->seek));
+  /* the render thread is ahead of the new position */
+  gst_egueb_src_pipeline_stop (thiz);
+  gst_egueb_src_position_set (thiz, thiz->seek);
+  thiz->seek = GST_CLOCK_TIME_NONE;
+}
+
+/* The frames in between are skipped, the next frame pushed is the one
+ * the step ends at, the step is done once it has been pushed
+ */
+static void
+gst_egueb_src_step_apply (GstEguebSrc * thiz)
+{
+  GstEvent *event;
+  GstFormat format;
+  guint64 amount;
+  gdouble rate;
+  gboolean flush;
+  gboolean intermediate;
+  guint64 duration;
+  gint64 skip;
+
+  GST_OBJECT_LOCK (thiz);
+  event = thiz->step;
+  thiz->step = NULL;
+  GST_OBJECT_UNLOCK (thiz);
+  if (!event)
+    return;
+
+  gst_event_parse_step (event, &format, &amount, &rate, &flush,
+      &intermediate);
+  /* the last frame stepped is the one pushed */
+  if (format == GST_FORMAT_BUFFERS) {
+    duration = gst_egueb_src_frames_time (thiz, amount);
+    skip = amount > 0 ? gst_egueb_src_frames_time (thiz, amount - 1) : 0;
+  } else {
+    duration = amount;
+    skip = amount > (guint64) thiz->duration ? amount - thiz->duration : 0;
+  }
+
+  if (GST_BASE_SRC (thiz)->segment.rate < 0) {
+    thiz->seek = thiz->last_ts > (guint64) skip ? thiz->last_ts - skip : 0;
+  } else {
+    thiz->seek = thiz->last_ts + skip;
+  }
+  GST_DEBUG_OBJECT (thiz, "Stepping %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (skip));
+  gst_egueb_src_seek_apply (thiz);
+
+  GST_OBJECT_LOCK (thiz);
+  if (thiz->step_done)
+    gst_message_unref (thiz->step_done);
+  thiz->step_done = gst_message_new_step_done (GST_OBJECT (thiz), format,
+      amount, rate, flush, intermediate, duration, FALSE);
+  GST_OBJECT_UNLOCK (thiz);
+  gst_event_unref (event);
+}
+
+static gboolean
+gst_egueb_src_is_seekable (GstBaseSrc *src)
+{
+  return !gst_base_src_is_live (src);
+}
+
+/* Whether the document never changes by itself. The animations are known
+ * once the document has been processed
+ */
+static gboolean
+gst_egueb_src_is_still (GstEguebSrc * thiz)
+{
+  gboolean ret;
+
+  if (!thiz->doc)
+    return FALSE;
+  if (!thiz->animation)
+    return TRUE;
+
+  g_mutex_lock (thiz->doc_lock);
+  egueb_dom_document_process (thiz->doc);
+  ret = !egueb_smil_feature_animation_has_animations (thiz->animation);
+  g_mutex_unlock (thiz->doc_lock);
+
+  return ret;
+}
+
+static void
+gst_egueb_src_fixate (GstBaseSrc * src, GstCaps * caps)
+{
+  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
+  gint i;
+  GstStructure *structure;
+  gboolean still = FALSE;
+
+  if (thiz->still_mode == GST_EGUEB_SRC_STILL_MODE_STILL)
+    still = gst_egueb_src_is_still (thiz);
+
+  for (i = 0; i < gst_caps_get_size (caps); ++i) {
+    structure = gst_caps_get_structure (caps, i);
+
+    /* in case the width or height are still not-fixed use the size of the
+     * content, or the default size if it is not known yet
+     */
+    gst_structure_fixate_field_nearest_int (structure, "width",
+        thiz->content_w ? thiz->content_w : thiz->container_w);
+    gst_structure_fixate_field_nearest_int (structure, "height",
+        thiz->content_h ? thiz->content_h : thiz->container_h);
+    /* fixate the framerate in case nobody has set it, a still image
+     * has no framerate at all
+     */
+    if (still)
+      gst_structure_fixate_field_nearest_fraction (structure, "framerate",
+          0, 1);
+    else
+      gst_structure_fixate_field_nearest_fraction (structure, "framerate",
+          30, 1);
+  }
+}
+
+static GstCaps *
+gst_egueb_src_get_caps (GstBaseSrc * src)
+{
+  GstEguebSrc * thiz = GST_EGUEB_SRC (src);
+  GstCaps *caps;
+  GstStructure *s;
+  GstStructure *argb;
+  GstStructure *yuv;
+  GValue formats = { 0 };
+  GValue format = { 0 };
+  Egueb_Dom_Feature_Window_Type type;
+  int cw, ch;
+
+  if (!thiz->doc) {
+    GST_DEBUG_OBJECT (thiz, "Can not get caps without a parsed document");
+    return gst_caps_copy (gst_pad_get_pad_template_caps (src->srcpad));
+  }
+
+  if (!egueb_dom_feature_window_type_get (thiz->window, &type)) {
+    GST_WARNING_OBJECT (thiz, "Impossible to get the type of the window");
+    return gst_caps_copy (gst_pad_get_pad_template_caps (src->srcpad));
+  }
+
+  if (type == EGUEB_DOM_FEATURE_WINDOW_TYPE_SLAVE) {
+    GST_ERROR_OBJECT (thiz, "Not supported yet");
+    return gst_caps_copy (gst_pad_get_pad_template_caps (src->srcpad));
+  } else {
+    g_mutex_lock (thiz->doc_lock);
+    egueb_dom_feature_window_content_size_set(thiz->window, thiz->container_w,
+        thiz->container_h);
+    egueb_dom_feature_window_content_size_get(thiz->window, &cw, &ch);
+    if (cw > 0 && ch > 0) {
+      thiz->content_w = cw;
+      thiz->content_h = ch;
+    }
+    /* keep the layout of the negotiated size, region and scale */
+    if (thiz->w && thiz->h)
+      gst_egueb_src_layout (thiz);
+    g_mutex_unlock (thiz->doc_lock);
+  }
+
+  if (cw <= 0 || ch <= 0) {
+    GST_WARNING_OBJECT (thiz, "Invalid size of the window %d %d", cw, ch);
+    return gst_caps_copy (gst_pad_get_pad_template_caps (src->srcpad));
+  }
+
+  /* the size of the content is the preferred one, but the document can be
+   * laid out at any other size
+   */
+  GST_DEBUG_OBJECT (thiz, "Content size is %dx%d", cw, ch);
+
+  /* create our own structure */
+  s = gst_structure_new ("video/x-raw-rgb",
+      "bpp", G_TYPE_INT, 32,
+      "depth", G_TYPE_INT, 24,
+      "endianness", G_TYPE_INT, G_BIG_ENDIAN,
+      "red_mask", G_TYPE_INT, 0x0000ff00,
+      "green_mask", G_TYPE_INT, 0x00ff0000,
+      "blue_mask", G_TYPE_INT, 0xff000000,
+      "framerate", GST_TYPE_FRACTION_RANGE, 0, 1, G_MAXINT, 1,
+      "width", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+      "height", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+      NULL);
+
+  /* the same with alpha, to composite it downstream */
+  argb = gst_structure_copy (s);
+  gst_structure_set (argb,
+      "depth", G_TYPE_INT, 32,
+      "alpha_mask", G_TYPE_INT, 0x000000ff,
+      NULL);
+
+  /* the same but on YUV, for the encoders */
+  yuv = gst_structure_new ("video/x-raw-yuv",
+      "framerate", GST_TYPE_FRACTION_RANGE, 0, 1, G_MAXINT, 1,
+      "width", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+      "height", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+      NULL);
+  g_value_init (&formats, GST_TYPE_LIST);
+  g_value_init (&format, GST_TYPE_FOURCC);
+  gst_value_set_fourcc (&format, GST_MAKE_FOURCC ('I', '4', '2', '0'));
+  gst_value_list_append_value (&formats, &format);
+  gst_value_set_fourcc (&format, GST_MAKE_FOURCC ('N', 'V', '1', '2'));
+  gst_value_list_append_value (&formats, &format);
+  gst_value_set_fourcc (&format, GST_MAKE_FOURCC ('Y', 'U', 'Y', '2'));
+  gst_value_list_append_value (&formats, &format);
+  gst_structure_set_value (yuv, "format", &formats);
+  g_value_unset (&format);
+  g_value_unset (&formats);
+
+  caps = gst_caps_new_full (s, argb, yuv, NULL);
+
+  /* only the viewport is output */
+  GST_OBJECT_LOCK (thiz);
+  if (thiz->viewport_set) {
+    gst_caps_set_simple (caps,
+        "width", G_TYPE_INT, thiz->viewport.w,
+        "height", G_TYPE_INT, thiz->viewport.h,
+        NULL);
+  }
+  GST_OBJECT_UNLOCK (thiz);
+
+  return caps;
+}
+
+/* Takes the viewport set by the application, returns whether the size of
+ * the output has to change
+ */
+static gboolean
+gst_egueb_src_viewport_update (GstEguebSrc * thiz)
+{
+  Eina_Rectangle viewport;
+  gboolean roi;
+  gboolean relayout;
+
+  GST_OBJECT_LOCK (thiz);
+  if (!thiz->viewport_changed) {
+    GST_OBJECT_UNLOCK (thiz);
+    return FALSE;
+  }
+  thiz->viewport_changed = FALSE;
+  roi = thiz->viewport_set;
+  viewport = thiz->viewport;
+  GST_OBJECT_UNLOCK (thiz);
+
+  if (!roi)
+    eina_rectangle_coords_from (&viewport, 0, 0, thiz->w, thiz->h);
+
+  relayout = roi != thiz->roi;
+  if (relayout || viewport.x != thiz->roi_x || viewport.y != thiz->roi_y) {
+    GST_DEBUG_OBJECT (thiz, "Moving the viewport to %d %d", viewport.x,
+        viewport.y);
+    /* the render thread draws with the current viewport */
+    gst_egueb_src_pipeline_stop (thiz);
+    /* the previous content has moved, draw everything again */
+    thiz->damage_all = TRUE;
+    if (thiz->coverage) {
+      gst_egueb_coverage_free (thiz->coverage);
+      thiz->coverage = NULL;
+    }
+    gst_egueb_cache_flush (thiz->cache);
+    thiz->store_dirty = TRUE;
+    thiz->roi = roi;
+    thiz->roi_x = viewport.x;
+    thiz->roi_y = viewport.y;
+  }
+
+  if (relayout && thiz->doc) {
+    g_mutex_lock (thiz->doc_lock);
+    gst_egueb_src_layout (thiz);
+    g_mutex_unlock (thiz->doc_lock);
+  }
+
+  return relayout || viewport.w != thiz->w || viewport.h != thiz->h;
+}
+
+static gboolean
+gst_egueb_src_set_caps (GstBaseSrc * src, GstCaps * caps)
+{
+  GstEguebSrc * thiz = GST_EGUEB_SRC (src);
+  GstStructure *s;
+  GstVideoFormat format;
+  const GValue *framerate;
+  gint width = thiz->w;
+  gint height = thiz->h;
+
+  /* the caps were chosen with the requested viewport */
+  gst_egueb_src_viewport_update (thiz);
+
+  if (!gst_video_format_parse_caps (caps, &format, &width, &height) ||
+      !gst_egueb_converter_format_supported (format)) {
+    GST_ERROR_OBJECT (thiz, "Unsupported caps %" GST_PTR_FORMAT, caps);
+    return FALSE;
+  }
+
+  /* get what downstream can change */
+  s = gst_caps_get_structure (caps, 0);
+
+  /* the framerate */
+  framerate = gst_structure_get_value (s, "framerate");
+  if (framerate && (thiz->spf_n !=
+      gst_value_get_fraction_denominator (framerate) || thiz->spf_d !=
+      gst_value_get_fraction_numerator (framerate))) {
+    /* the frames drawn ahead are at the previous rate, the frames are
+     * counted again from here
+     */
+    gst_egueb_src_pipeline_stop (thiz);
+    gst_egueb_src_position_set (thiz, thiz->last_ts);
+
+    /* Store this FPS for use when generating buffers */
+    thiz->spf_n = gst_value_get_fraction_denominator (framerate);
+    thiz->spf_d = gst_value_get_fraction_numerator (framerate);
+
+    GST_DEBUG_OBJECT (thiz, "Setting framerate to %d/%d", thiz->spf_d, thiz->spf_n);
+    /* a still image, only one frame is sent */
+    if (!thiz->spf_d) {
+      thiz->duration = 0;
+      thiz->fps = 0;
+    } else {
+      thiz->duration = gst_util_uint64_scale (GST_SECOND, thiz->spf_n,
+          thiz->spf_d);
+      thiz->fps = gst_util_uint64_scale (1, thiz->spf_d, thiz->spf_n);
+    }
+    gst_egueb_cache_flush (thiz->cache);
+    
+    if (thiz->animation && thiz->fps) {
+      egueb_smil_feature_animation_fps_set(thiz->animation, thiz->fps);
+    }
+  }
+
+  /* the buffers of the pool and the cached frames are no longer valid */
+  if (format != thiz->format || width != thiz->w || height != thiz->h) {
+    gst_egueb_pool_flush (thiz->pool);
+    gst_egueb_cache_flush (thiz->cache);
+  }
+  thiz->store_dirty = TRUE;
+
+  /* the size and format */
+  if (format != thiz->format) {
+    GST_INFO_OBJECT (thiz, "Setting format to %" GST_FOURCC_FORMAT,
+        GST_FOURCC_ARGS (gst_video_format_to_fourcc (format)));
+    gst_egueb_src_pipeline_stop (thiz);
+    /* the last frame can not be reused */
+    if (thiz->last) {
+      gst_buffer_unref (thiz->last);
+      thiz->last = NULL;
+    }
+    thiz->format = format;
+  }
+
+  if (width != thiz->w || height != thiz->h) {
+    /* the render thread draws with the current size */
+    gst_egueb_src_pipeline_stop (thiz);
+    if (thiz->s) {
+      enesim_surface_unref (thiz->s);
+      thiz->s = NULL;
+    }
+    if (thiz->small) {
+      enesim_surface_unref (thiz->small);
+      thiz->small = NULL;
+    }
+
+    /* the last frame is no longer valid */
+    if (thiz->last) {
+      gst_buffer_unref (thiz->last);
+      thiz->last = NULL;
+    }
+
+    if (thiz->coverage) {
+      gst_egueb_coverage_free (thiz->coverage);
+      thiz->coverage = NULL;
+    }
+
+    /* the surface will be created on the next frame */
+    thiz->w = width;
+    thiz->h = height;
+
+    /* lay out the document at the new size, it is rasterized there */
+    GST_INFO_OBJECT (thiz, "Setting size to %dx%d", width, height);
+    g_mutex_lock (thiz->doc_lock);
+    gst_egueb_src_layout (thiz);
+    g_mutex_unlock (thiz->doc_lock);
+  }
+
+  return TRUE;
+}
+
+/* Downstream must accept the new size of the viewport */
+static void
+gst_egueb_src_viewport_negotiate (GstEguebSrc * thiz)
+{
+  GstPad *pad = GST_BASE_SRC_PAD (thiz);
+  GstCaps *caps;
+  gint width;
+  gint height;
 
-    default:
-    break;
+  if (!GST_PAD_CAPS (pad))
+    return;
+
+  if (thiz->roi) {
+    GST_OBJECT_LOCK (thiz);
+    width = thiz->viewport.w;
+    height = thiz->viewport.h;
+    GST_OBJECT_UNLOCK (thiz);
+  } else {
+    width = thiz->content_w;
+    height = thiz->content_h;
   }
 
-  if (!ret)
-    ret = GST_BASE_SRC_CLASS (parent_class)->query (src, query);
+  if (width <= 0 || height <= 0 || (width == thiz->w && height == thiz->h))
+    return;
 
-  return ret;
+  caps = gst_caps_copy (GST_PAD_CAPS (pad));
+  gst_caps_set_simple (caps,
+      "width", G_TYPE_INT, width,
+      "height", G_TYPE_INT, height,
+      NULL);
+  if (!gst_pad_peer_accept_caps (pad, caps) || !gst_pad_set_caps (pad, caps))
+    GST_WARNING_OBJECT (thiz, "Downstream does not accept a viewport of "
+        "%dx%d", width, height);
+  gst_caps_unref (caps);
 }
 
+/* Takes the level chosen from the QoS events, returns whether frames have
+ * to be skipped
+ */
 static gboolean
-gst_egueb_src_prepare_seek_segment (GstBaseSrc *src, GstEvent *seek,
-    GstSegment *segment)
+gst_egueb_src_qos_apply (GstEguebSrc * thiz)
 {
-  GST_ERROR ("prepare seek");
-  return TRUE;
+  Gst_Egueb_Qos_Level level;
+  gint scale;
+
+  GST_OBJECT_LOCK (thiz);
+  level = gst_egueb_qos_level_get (thiz->qos);
+  GST_OBJECT_UNLOCK (thiz);
+
+  scale = gst_egueb_qos_level_scale (level);
+  if (scale != thiz->scale) {
+    GST_DEBUG_OBJECT (thiz, "Drawing at 1/%d of the size", scale);
+    gst_egueb_src_pipeline_stop (thiz);
+    thiz->scale = scale;
+    if (thiz->small) {
+      enesim_surface_unref (thiz->small);
+      thiz->small = NULL;
+    }
+    if (thiz->coverage) {
+      gst_egueb_coverage_free (thiz->coverage);
+      thiz->coverage = NULL;
+    }
+    thiz->damage_all = TRUE;
+    if (thiz->doc) {
+      g_mutex_lock (thiz->doc_lock);
+      gst_egueb_src_layout (thiz);
+      g_mutex_unlock (thiz->doc_lock);
+    }
+  }
+
+  return gst_egueb_qos_level_skip (level);
 }
 
-static gboolean
-gst_egueb_src_do_seek (GstBaseSrc *src, GstSegment *segment)
+/* Jumps over the frames that would reach downstream after their deadline,
+ * the document is neither processed nor drawn for them. The next frame
+ * created is the first one on time
+ */
+static void
+gst_egueb_src_late_skip (GstEguebSrc * thiz)
 {
-  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
+  GstBaseSrc *src = GST_BASE_SRC (thiz);
+  GstClockTime earliest;
+  GstClockTime stop;
+  gint64 running = 0;
+  guint64 dropped = 0;
+
+  if (!thiz->skip_late || src->segment.rate != 1.0 || thiz->duration <= 0)
+    return;
+
+  GST_OBJECT_LOCK (thiz);
+  earliest = thiz->earliest;
+  GST_OBJECT_UNLOCK (thiz);
+  if (!GST_CLOCK_TIME_IS_VALID (earliest))
+    return;
+
+  stop = thiz->last_stop;
+  if (GST_CLOCK_TIME_IS_VALID (src->segment.stop) &&
+      (GstClockTime) src->segment.stop < stop)
+    stop = src->segment.stop;
+
+  /* always keep a frame to send */
+  while (thiz->last_ts + thiz->duration < stop) {
+    running = gst_segment_to_running_time (&src->segment, GST_FORMAT_TIME,
+        thiz->last_ts);
+    if (running < 0 || (GstClockTime) running + thiz->duration > earliest)
+      break;
+    gst_egueb_src_position_advance (thiz, 1);
+    dropped++;
+  }
+  if (!dropped)
+    return;
 
-  g_mutex_lock (thiz->doc_lock);
-  /* TODO find the nearest keyframe based on the fps */
-  GST_DEBUG_OBJECT (src, "do seek at %" GST_TIME_FORMAT, GST_TIME_ARGS (segment->start));
-  /* do the seek on the svg element */
-  thiz->seek = segment->start;
-  g_mutex_unlock (thiz->doc_lock);
+  GST_DEBUG_OBJECT (thiz, "Skipped %" G_GUINT64_FORMAT " late frames up to %"
+      GST_TIME_FORMAT, dropped, GST_TIME_ARGS (thiz->last_ts));
+  /* the render thread drew the frames we are skipping */
+  gst_egueb_src_pipeline_stop (thiz);
 
-  return TRUE;
+  GST_OBJECT_LOCK (thiz);
+  thiz->dropped += dropped;
+  GST_OBJECT_UNLOCK (thiz);
+
+  {
+    GstMessage *msg;
+
+    msg = gst_message_new_qos (GST_OBJECT (thiz), FALSE, running,
+        thiz->last_ts, thiz->last_ts, thiz->duration);
+    gst_message_set_qos_values (msg, earliest - running, 1.0, 1000000);
+    gst_message_set_qos_stats (msg, GST_FORMAT_BUFFERS, thiz->processed,
+        thiz->dropped);
+    gst_element_post_message (GST_ELEMENT (thiz), msg);
+  }
 }
 
+/* The buffer shows the input events drawn on it, the time since they were
+ * received is their input to photon latency. It is also the frame a step
+ * ends at
+ */
 static gboolean
-gst_egueb_src_is_seekable (GstBaseSrc *src)
+gst_egueb_src_buffer_probe (GstPad * pad, GstBuffer * buffer, gpointer data)
 {
+  GstEguebSrc *thiz = data;
+  GstMessage *step_done;
+  GstClockTime now;
+  GstClockTime min = GST_CLOCK_TIME_NONE;
+  GstClockTime max = 0;
+  guint count;
+  guint i;
+
+  GST_OBJECT_LOCK (thiz);
+  step_done = thiz->step_done;
+  thiz->step_done = NULL;
+  GST_OBJECT_UNLOCK (thiz);
+  if (step_done)
+    gst_element_post_message (GST_ELEMENT (thiz), step_done);
+
+  count = thiz->input_ready->len;
+  if (!count)
+    return TRUE;
+
+  now = gst_util_get_timestamp ();
+  GST_OBJECT_LOCK (thiz);
+  for (i = 0; i < count; i++) {
+    GstClockTime latency;
+    gint b;
+
+    latency = now - g_array_index (thiz->input_ready, GstClockTime, i);
+    gst_egueb_latency_add (thiz->input_latency, latency);
+    for (b = 0; b < GST_EGUEB_SRC_INPUT_BUCKETS - 1; b++) {
+      if (latency <= input_buckets[b])
+        break;
+    }
+    thiz->input_histogram[b]++;
+    min = MIN (min, latency);
+    max = MAX (max, latency);
+  }
+  thiz->input_events += count;
+  if (!GST_CLOCK_TIME_IS_VALID (thiz->input_min) || min < thiz->input_min)
+    thiz->input_min = min;
+  if (!GST_CLOCK_TIME_IS_VALID (thiz->input_max) || max > thiz->input_max)
+    thiz->input_max = max;
+  GST_OBJECT_UNLOCK (thiz);
+  g_array_set_size (thiz->input_ready, 0);
+
+  GST_LOG_OBJECT (thiz, "%u input events shown after %" GST_TIME_FORMAT
+      " to %" GST_TIME_FORMAT, count, GST_TIME_ARGS (min), GST_TIME_ARGS (max));
+  gst_element_post_message (GST_ELEMENT (thiz),
+      gst_message_new_element (GST_OBJECT (thiz),
+          gst_structure_new ("egueb-input-latency",
+              "timestamp", G_TYPE_UINT64, GST_BUFFER_TIMESTAMP (buffer),
+              "events", G_TYPE_UINT, count,
+              "min", G_TYPE_UINT64, min,
+              "max", G_TYPE_UINT64, max,
+              NULL)));
+
   return TRUE;
 }
 
-static void
-gst_egueb_src_fixate (GstBaseSrc * src, GstCaps * caps)
+static GstStructure *
+gst_egueb_src_input_stats_get (GstEguebSrc * thiz)
 {
-  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
+  GstStructure *s;
   gint i;
-  GstStructure *structure;
 
-  for (i = 0; i < gst_caps_get_size (caps); ++i) {
-    structure = gst_caps_get_structure (caps, i);
+  GST_OBJECT_LOCK (thiz);
+  s = gst_structure_new ("egueb-input-latency-stats",
+      "events", G_TYPE_UINT64, thiz->input_events,
+      "min", G_TYPE_UINT64, thiz->input_min,
+      "max", G_TYPE_UINT64, thiz->input_max,
+      "p50", G_TYPE_UINT64,
+      gst_egueb_latency_percentile_get (thiz->input_latency, 50.0),
+      "p99", G_TYPE_UINT64,
+      gst_egueb_latency_percentile_get (thiz->input_latency, 99.0),
+      NULL);
+  for (i = 0; i < GST_EGUEB_SRC_INPUT_BUCKETS; i++)
+    gst_structure_set (s, input_bucket_names[i], G_TYPE_UINT64,
+        thiz->input_histogram[i], NULL);
+  GST_OBJECT_UNLOCK (thiz);
 
-    /* in case the width or height are still not-fixed use the default size */
-    gst_structure_fixate_field_nearest_int (structure, "width",
-        thiz->container_w);
-    gst_structure_fixate_field_nearest_int (structure, "height",
-        thiz->container_h);
-    /* fixate the framerate in case nobody has set it */
-    gst_structure_fixate_field_nearest_fraction (structure, "framerate", 30, 1);
-  }
+  return s;
 }
 
-static GstCaps *
-gst_egueb_src_get_caps (GstBaseSrc * src)
+/* A still image has been sent, nothing else is sent until a flush or
+ * until the input changes the document. The new image is sent at the
+ * current running time
+ */
+static GstFlowReturn
+gst_egueb_src_still_wait (GstEguebSrc * thiz)
 {
-  GstEguebSrc * thiz = GST_EGUEB_SRC (src);
-  GstCaps *caps;
-  GstStructure *s;
-  Egueb_Dom_Feature_Window_Type type;
-  int cw, ch;
-
-  if (!thiz->doc) {
-    GST_DEBUG_OBJECT (thiz, "Can not get caps without a parsed document");
-    return gst_caps_copy (gst_pad_get_pad_template_caps (src->srcpad));
+  GstClock *clock;
+  gboolean unlock;
+
+  GST_DEBUG_OBJECT (thiz, "Still image sent, waiting");
+  GST_OBJECT_LOCK (thiz);
+  while (!thiz->still_unlock && !thiz->still_wake)
+    g_cond_wait (thiz->still_cond, GST_OBJECT_GET_LOCK (thiz));
+  unlock = thiz->still_unlock;
+  thiz->still_wake = FALSE;
+  GST_OBJECT_UNLOCK (thiz);
+
+  if (unlock)
+    return GST_FLOW_WRONG_STATE;
+
+  clock = gst_element_get_clock (GST_ELEMENT (thiz));
+  if (clock) {
+    GstClockTime now;
+    GstClockTime base_time;
+
+    now = gst_clock_get_time (clock);
+    base_time = gst_element_get_base_time (GST_ELEMENT (thiz));
+    if (now > base_time)
+      gst_egueb_src_position_set (thiz, now - base_time);
+    gst_object_unref (clock);
   }
+  GST_DEBUG_OBJECT (thiz, "Input received, sending a new image");
 
-#if 0
-  /* For ARGB888 */
-      "alpha_mask", G_TYPE_INT, 0x000000ff,
-      "red_mask", G_TYPE_INT, 0x0000ff00,
-      "green_mask", G_TYPE_INT, 0x00ff0000,
-      "blue_mask", G_TYPE_INT, 0xff000000,
-#endif
+  return GST_FLOW_OK;
+}
 
-  /* create our own structure */
-  s = gst_structure_new ("video/x-raw-rgb",
-      "bpp", G_TYPE_INT, 32,
-      "depth", G_TYPE_INT, 24,
-      "endianness", G_TYPE_INT, G_BIG_ENDIAN,
-      "red_mask", G_TYPE_INT, 0x0000ff00,
-      "green_mask", G_TYPE_INT, 0x00ff0000,
-      "blue_mask", G_TYPE_INT, 0xff000000,
-      "framerate", GST_TYPE_FRACTION_RANGE, 1, G_MAXINT, G_MAXINT, 1,
-      NULL);
+/* Waits until the running time of the next frame, it is drawn only then.
+ * When that time plus the latency of the pipeline has already passed, the
+ * frames until the next one on time are never drawn
+ */
+static GstFlowReturn
+gst_egueb_src_live_wait (GstEguebSrc * thiz)
+{
+  GstClock *clock;
+  GstClockID id;
+  GstClockTime base_time;
+  GstClockTime latency;
+  GstClockTime now;
+  GstClockReturn ret;
 
-  if (!egueb_dom_feature_window_type_get (thiz->window, &type)) {
-    GST_WARNING_OBJECT (thiz, "Impossible to get the type of the window");
-    return gst_caps_copy (gst_pad_get_pad_template_caps (src->srcpad));
-  }
+  clock = gst_element_get_clock (GST_ELEMENT (thiz));
+  if (!clock)
+    return GST_FLOW_OK;
 
-  if (type == EGUEB_DOM_FEATURE_WINDOW_TYPE_SLAVE) {
-    GST_ERROR_OBJECT (thiz, "Not supported yet");
-    return gst_caps_copy (gst_pad_get_pad_template_caps (src->srcpad));
-  } else {
-    egueb_dom_feature_window_content_size_set(thiz->window, thiz->container_w,
-        thiz->container_h);
-    egueb_dom_feature_window_content_size_get(thiz->window, &cw, &ch);
+  /* the sinks show the frames once the latency has passed, until then
+   * they are not late
+   */
+  GST_OBJECT_LOCK (thiz);
+  latency = thiz->latency_configured;
+  GST_OBJECT_UNLOCK (thiz);
+  if (!GST_CLOCK_TIME_IS_VALID (latency))
+    latency = gst_egueb_src_latency_get (thiz);
+
+  base_time = gst_element_get_base_time (GST_ELEMENT (thiz));
+  now = gst_clock_get_time (clock);
+  now = now > base_time ? now - base_time : 0;
+  if (thiz->duration > 0 && thiz->last_ts + latency < now) {
+    gint64 frame;
+
+    /* the first frame still on time */
+    frame = gst_util_uint64_scale (now - latency - thiz->position_base,
+        thiz->spf_d, (guint64) thiz->spf_n * GST_SECOND) + 1;
+    GST_DEBUG_OBJECT (thiz, "Late, moving %" G_GINT64_FORMAT " frames from %"
+        GST_TIME_FORMAT, frame - thiz->position_frame,
+        GST_TIME_ARGS (thiz->last_ts));
+    if (thiz->frame_sent) {
+      GST_OBJECT_LOCK (thiz);
+      thiz->dropped += frame - thiz->position_frame;
+      GST_OBJECT_UNLOCK (thiz);
+    }
+    /* the render thread drew the frames we are skipping */
+    gst_egueb_src_pipeline_stop (thiz);
+    gst_egueb_src_position_advance (thiz, frame - thiz->position_frame);
   }
 
-  if (cw <= 0 || ch <= 0) {
-    GST_WARNING_OBJECT (thiz, "Invalid size of the window %d %d", cw, ch);
-    return gst_caps_copy (gst_pad_get_pad_template_caps (src->srcpad));
+  GST_OBJECT_LOCK (thiz);
+  if (thiz->still_unlock) {
+    GST_OBJECT_UNLOCK (thiz);
+    gst_object_unref (clock);
+    return GST_FLOW_WRONG_STATE;
   }
+  id = thiz->clock_id = gst_clock_new_single_shot_id (clock,
+      base_time + thiz->last_ts);
+  GST_OBJECT_UNLOCK (thiz);
 
-  gst_structure_set (s, "width", G_TYPE_INT, cw, NULL);
-  gst_structure_set (s, "height", G_TYPE_INT, ch, NULL);
-
-#if 0
-  GST_DEBUG_OBJECT (thiz, "Using a range for the height");
-  gst_structure_set (s, "height", GST_TYPE_INT_RANGE, 1, G_MAXINT, NULL);
-  GST_DEBUG_OBJECT (thiz, "Using a range for the width");
-  gst_structure_set (s, "width", GST_TYPE_INT_RANGE, 1, G_MAXINT, NULL);
-#endif
+  ret = gst_clock_id_wait (id, NULL);
 
-  caps = gst_caps_new_full (s, NULL);
+  GST_OBJECT_LOCK (thiz);
+  thiz->clock_id = NULL;
+  GST_OBJECT_UNLOCK (thiz);
+  gst_clock_id_unref (id);
+  gst_object_unref (clock);
 
-  return caps;
+  if (ret == GST_CLOCK_UNSCHEDULED)
+    return GST_FLOW_WRONG_STATE;
+  return GST_FLOW_OK;
 }
 
 static gboolean
-gst_egueb_src_set_caps (GstBaseSrc * src, GstCaps * caps)
+gst_egueb_src_unlock (GstBaseSrc * src)
 {
-  GstEguebSrc * thiz = GST_EGUEB_SRC (src);
-  GstStructure *s;
-  const GValue *framerate;
-  gint width = thiz->w;
-  gint height = thiz->h;
-
-  /* get what downstream can change */
-  s = gst_caps_get_structure (caps, 0);
-
-  /* the framerate */
-  framerate = gst_structure_get_value (s, "framerate");
-  if (framerate) {
-
-    /* Store this FPS for use when generating buffers */
-    thiz->spf_n = gst_value_get_fraction_denominator (framerate);
-    thiz->spf_d = gst_value_get_fraction_numerator (framerate);
+  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
 
-    GST_DEBUG_OBJECT (thiz, "Setting framerate to %d/%d", thiz->spf_d, thiz->spf_n);
-    thiz->duration = gst_util_uint64_scale (GST_SECOND, thiz->spf_n, thiz->spf_d);
-    thiz->fps = gst_util_uint64_scale (1, thiz->spf_d, thiz->spf_n);
-    
-    if (thiz->animation) {
-      egueb_smil_feature_animation_fps_set(thiz->animation, thiz->fps);
-    }
-  }
+  GST_OBJECT_LOCK (thiz);
+  thiz->still_unlock = TRUE;
+  g_cond_broadcast (thiz->still_cond);
+  if (thiz->clock_id)
+    gst_clock_id_unschedule (thiz->clock_id);
+  GST_OBJECT_UNLOCK (thiz);
 
-  /* the size */
-  gst_structure_get_int (s, "width", &width);
-  gst_structure_get_int (s, "height", &height);
-  if (width != thiz->w || height != thiz->h) {
-    if (thiz->s) {
-      enesim_surface_unref (thiz->s);
-      thiz->s = NULL;
-    }
+  return TRUE;
+}
 
-    thiz->s = enesim_surface_new (ENESIM_FORMAT_ARGB8888, width, height);
-    thiz->w = width;
-    thiz->h = height;
+static gboolean
+gst_egueb_src_unlock_stop (GstBaseSrc * src)
+{
+  GstEguebSrc *thiz = GST_EGUEB_SRC (src);
 
-    GST_INFO_OBJECT (thiz, "Setting size to %dx%d", width, height);
-    egueb_dom_feature_window_content_size_set (thiz->window, width, height);
-  }
+  GST_OBJECT_LOCK (thiz);
+  thiz->still_unlock = FALSE;
+  GST_OBJECT_UNLOCK (thiz);
 
   return TRUE;
 }
@@ -571,82 +2764,124 @@ gst_egueb_src_create (GstBaseSrc * src, guint64 offset, guint size,
     GstBuffer ** buf)
 {
   GstEguebSrc *thiz = GST_EGUEB_SRC (src);
-  GstFlowReturn ret;
-  GstClockID id;
-  GstBuffer *outbuf = NULL;
-  GstClockTime next;
-  Enesim_Buffer *eb;
-  Enesim_Buffer_Sw_Data sw_data;
-  gulong buffer_size;
-  gulong new_buffer_size;
-  gint fps;
-  
+  GstBuffer *outbuf;
+  gboolean skip;
+  gboolean repeat = FALSE;
+  GstClockTime start;
+  gint64 step;
+
   GST_DEBUG_OBJECT (thiz, "Creating %" GST_TIME_FORMAT, GST_TIME_ARGS (offset));
 
+  /* check if we need to seek */
+  if (GST_CLOCK_TIME_IS_VALID (thiz->seek))
+    gst_egueb_src_seek_apply (thiz);
+
+  if (thiz->step)
+    gst_egueb_src_step_apply (thiz);
+
+  if (thiz->segment_done) {
+    GST_DEBUG_OBJECT (thiz, "Segment start reached");
+    goto eos;
+  }
+
   /* check if we need to update the new segment */
   if (thiz->animation) {
     Egueb_Smil_Clock clock;
 
     if (!egueb_smil_feature_animation_has_animations(thiz->animation)) {
-      if (thiz->last_ts > 0) {
+      if (thiz->still_mode == GST_EGUEB_SRC_STILL_MODE_EOS &&
+          thiz->last_ts > 0) {
         GST_DEBUG ("No animations found, nothing else to push");
-        return GST_FLOW_UNEXPECTED;
+        goto eos;
       }
     } else if (egueb_smil_feature_animation_duration_get(thiz->animation, &clock)) {
       if (thiz->last_stop < clock) {
         gst_base_src_new_seamless_segment (src, 0, clock, thiz->last_ts); 
       } else if (thiz->last_stop > clock) {
         GST_DEBUG ("EOS");
-        return GST_FLOW_UNEXPECTED;
+        goto eos;
       }
       thiz->last_stop = clock;
     }
   }
 
+  /* a document that does not change by itself, with or without the
+   * animation feature
+   */
+  if (thiz->still_mode != GST_EGUEB_SRC_STILL_MODE_EOS && thiz->last &&
+      thiz->frame_sent && (!thiz->animation ||
+      !egueb_smil_feature_animation_has_animations (thiz->animation))) {
+    /* without a framerate of 0/1 the frame is repeated instead */
+    if (thiz->still_mode == GST_EGUEB_SRC_STILL_MODE_STILL && !thiz->spf_d) {
+      GstFlowReturn ret;
+
+      ret = gst_egueb_src_still_wait (thiz);
+      if (ret != GST_FLOW_OK)
+        return ret;
+    } else {
+      repeat = TRUE;
+    }
+  }
+
   /* check if we need to send the EOS */
   if (thiz->last_ts >= thiz->last_stop) {
         GST_DEBUG ("EOS reached, current: %" GST_TIME_FORMAT " stop: %" GST_TIME_FORMAT,
             GST_TIME_ARGS (thiz->last_ts), GST_TIME_ARGS (thiz->last_stop));
-        return GST_FLOW_UNEXPECTED;
+        goto eos;
   }
 
-#if 0
-  /* check if we need to seek */
-  if (GST_CLOCK_TIME_IS_VALID (thiz->seek)) {
-    gdouble seconds;
-
-    seconds = thiz->seek / 1000000000.0;
-    egueb_svg_element_svg_time_set (thiz->svg, seconds);
-    thiz->last_ts = thiz->seek;
-    thiz->seek = GST_CLOCK_TIME_NONE;
+  /* the end of the seek segment */
+  if (GST_CLOCK_TIME_IS_VALID (src->segment.stop) &&
+      thiz->last_ts >= src->segment.stop) {
+    GST_DEBUG_OBJECT (thiz, "Segment stop reached");
+    goto eos;
   }
-#endif
 
-  buffer_size = gst_egueb_src_get_size (thiz);
+  if (gst_base_src_is_live (src)) {
+    GstFlowReturn ret;
 
-  /* We need to check downstream if the caps have changed so we can
-   * allocate an optimus size of surface
-   */
-  ret = gst_pad_alloc_buffer_and_set_caps (GST_BASE_SRC_PAD (src), src->offset,
-      buffer_size, GST_PAD_CAPS (GST_BASE_SRC_PAD (src)), &outbuf);
-  if (ret == GST_FLOW_OK) {
-    new_buffer_size = GST_BUFFER_SIZE (outbuf);
-    buffer_size = gst_egueb_src_get_size (thiz);
-    if (new_buffer_size != buffer_size) {
-      GST_ERROR_OBJECT (thiz, "different size %d %d", new_buffer_size, buffer_size);
-      gst_buffer_unref (outbuf);
-      outbuf = NULL;
-    }
-  } else {
-    outbuf = NULL;
+    ret = gst_egueb_src_live_wait (thiz);
+    if (ret != GST_FLOW_OK)
+      return ret;
   }
 
-  gst_egueb_src_draw (thiz);
+  /* the input might change the document */
+  if (gst_egueb_src_navigation_apply (thiz))
+    repeat = FALSE;
 
-  if (thiz->animation) {
-    egueb_smil_feature_animation_tick (thiz->animation);
+  /* the same frame again, nothing is processed nor drawn */
+  if (repeat) {
+    outbuf = gst_egueb_src_last_repeat (thiz);
+    gst_egueb_src_renditions_repeat (thiz);
+    goto send;
+  }
+
+  if (gst_egueb_src_viewport_update (thiz))
+    gst_egueb_src_viewport_negotiate (thiz);
+
+  skip = gst_egueb_src_qos_apply (thiz);
+  gst_egueb_src_late_skip (thiz);
+
+  start = gst_util_get_timestamp ();
+
+  /* the other rates need the document on this thread */
+  if (skip && thiz->last && thiz->duration > 0 &&
+      thiz->position_frame % 2) {
+    GST_LOG_OBJECT (thiz, "Skipping a frame");
+    outbuf = gst_egueb_src_last_repeat (thiz);
+    gst_egueb_src_renditions_repeat (thiz);
+  } else if (thiz->pipeline && thiz->scale == 1 &&
+      src->segment.rate == 1.0) {
+    outbuf = gst_egueb_src_pipeline_frame_get (thiz);
+    if (!outbuf)
+      return GST_FLOW_WRONG_STATE;
+  } else {
+    gst_egueb_src_pipeline_stop (thiz);
+    outbuf = gst_egueb_src_cache_frame_get (thiz);
   }
+  gst_egueb_src_latency_add (thiz, gst_util_get_timestamp () - start);
 
+send:
 #if 0
   /* TODO add a property to inform when to send an EOS, like after
    * every animation has ended
@@ -658,21 +2893,91 @@ gst_egueb_src_create (GstBaseSrc * src, guint64 offset, guint size,
   }
 #endif
 
-  gst_egueb_src_convert (thiz, &outbuf);
   GST_DEBUG_OBJECT (thiz, "Sending buffer with ts: %" GST_TIME_FORMAT, GST_TIME_ARGS (thiz->last_ts));
 
-  /* set the duration for the next buffer, this must be done after the tick in case
-   * the QoS changed the fps on the svg
+  /* set the timestamp and duration based on the position, the duration
+   * is on content time and ends where the next frame starts
    */
-  thiz->duration = gst_util_uint64_scale (GST_SECOND, 1, thiz->fps);
-  /* set the timestamp and duration baesed on the last timestamp set */
-  GST_BUFFER_DURATION (outbuf) = thiz->duration;
+  step = (gint64) (gst_egueb_src_position_at (thiz, thiz->position_base,
+      thiz->position_frame + 1) - thiz->last_ts);
+  GST_BUFFER_DURATION (outbuf) = step ? ABS (step) : GST_CLOCK_TIME_NONE;
   GST_BUFFER_TIMESTAMP (outbuf) = thiz->last_ts;
-  thiz->last_ts += GST_BUFFER_DURATION (outbuf);
+  thiz->processed++;
+  thiz->frame_sent = TRUE;
+  gst_egueb_src_renditions_push (thiz, thiz->last_ts,
+      GST_BUFFER_DURATION (outbuf));
+  if (step < 0 && (gint64) thiz->last_ts < src->segment.start - step)
+    thiz->segment_done = TRUE;
+  else
+    gst_egueb_src_position_advance (thiz, 1);
 
   *buf = outbuf;
 
   return GST_FLOW_OK;
+
+eos:
+  /* our own pad gets it from the base class */
+  gst_egueb_src_renditions_push_event (thiz, gst_event_new_eos ());
+  return GST_FLOW_UNEXPECTED;
+}
+
+static GstPad *
+gst_egueb_src_request_new_pad (GstElement * element, GstPadTemplate * templ,
+    const gchar * name)
+{
+  GstEguebSrc *thiz = GST_EGUEB_SRC (element);
+  GstEguebSrcRendition *r;
+  GstPad *pad;
+  gchar *pad_name;
+
+  if (name)
+    pad_name = g_strdup (name);
+  else
+    pad_name = g_strdup_printf ("video_%u", thiz->renditions_count);
+  thiz->renditions_count++;
+
+  pad = gst_pad_new_from_template (templ, pad_name);
+  g_free (pad_name);
+
+  r = g_new0 (GstEguebSrcRendition, 1);
+  r->pad = pad;
+  r->format = GST_VIDEO_FORMAT_UNKNOWN;
+  r->pool = gst_egueb_pool_new ();
+  gst_egueb_pool_max_set (r->pool, thiz->max_buffers);
+  r->need_segment = TRUE;
+  gst_pad_set_element_private (pad, r);
+  gst_pad_set_getcaps_function (pad,
+      GST_DEBUG_FUNCPTR (gst_egueb_src_rendition_get_caps));
+  gst_pad_set_setcaps_function (pad,
+      GST_DEBUG_FUNCPTR (gst_egueb_src_rendition_set_caps));
+
+  /* the renditions are used from the streaming thread */
+  GST_PAD_STREAM_LOCK (GST_BASE_SRC_PAD (thiz));
+  thiz->renditions = g_list_append (thiz->renditions, r);
+  GST_PAD_STREAM_UNLOCK (GST_BASE_SRC_PAD (thiz));
+
+  if (GST_STATE (element) > GST_STATE_READY)
+    gst_pad_set_active (pad, TRUE);
+  gst_element_add_pad (element, pad);
+  GST_DEBUG_OBJECT (thiz, "New rendition pad %s", GST_PAD_NAME (pad));
+
+  return pad;
+}
+
+static void
+gst_egueb_src_release_pad (GstElement * element, GstPad * pad)
+{
+  GstEguebSrc *thiz = GST_EGUEB_SRC (element);
+  GstEguebSrcRendition *r = gst_pad_get_element_private (pad);
+
+  GST_DEBUG_OBJECT (thiz, "Releasing rendition pad %s", GST_PAD_NAME (pad));
+  GST_PAD_STREAM_LOCK (GST_BASE_SRC_PAD (thiz));
+  thiz->renditions = g_list_remove (thiz->renditions, r);
+  GST_PAD_STREAM_UNLOCK (GST_BASE_SRC_PAD (thiz));
+
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+  gst_egueb_src_rendition_free (r);
 }
 
 static void
@@ -698,6 +3003,97 @@ gst_egueb_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_URI:
       g_value_set_string (value, thiz->location);
       break;
+    case PROP_ZERO_COPY:
+      g_value_set_boolean (value, thiz->zero_copy);
+      break;
+    case PROP_MARK_REPEATED:
+      g_value_set_boolean (value, thiz->mark_repeated);
+      break;
+    case PROP_DAMAGE_RECT_COST:
+      g_value_set_uint (value, thiz->damage_rect_cost);
+      break;
+    case PROP_DAMAGE_PIXELS:
+      GST_OBJECT_LOCK (thiz);
+      g_value_set_uint64 (value, thiz->damage_pixels);
+      GST_OBJECT_UNLOCK (thiz);
+      break;
+    case PROP_DAMAGE_PIXELS_SAVED:
+      GST_OBJECT_LOCK (thiz);
+      g_value_set_int64 (value, thiz->damage_pixels_saved);
+      GST_OBJECT_UNLOCK (thiz);
+      break;
+    case PROP_PIPELINE:
+      g_value_set_boolean (value, thiz->pipeline);
+      break;
+    case PROP_PREMULTIPLIED:
+      g_value_set_boolean (value, thiz->premultiplied);
+      break;
+    case PROP_MAX_BUFFERS:
+      g_value_set_uint (value, thiz->max_buffers);
+      break;
+    case PROP_LOOP_PERIOD:
+      g_value_set_uint64 (value, thiz->loop_period);
+      break;
+    case PROP_CACHE_MAX_BYTES:
+      g_value_set_uint64 (value, thiz->cache_max_bytes);
+      break;
+    case PROP_CACHE_HITS:
+      GST_OBJECT_LOCK (thiz);
+      g_value_set_uint64 (value, thiz->cache_hits);
+      GST_OBJECT_UNLOCK (thiz);
+      break;
+    case PROP_CACHE_MISSES:
+      GST_OBJECT_LOCK (thiz);
+      g_value_set_uint64 (value, thiz->cache_misses);
+      GST_OBJECT_UNLOCK (thiz);
+      break;
+    case PROP_CACHE_DIR:
+      g_value_set_string (value, thiz->cache_dir);
+      break;
+    case PROP_CACHE_DIR_MAX_BYTES:
+      g_value_set_uint64 (value, thiz->cache_dir_max_bytes);
+      break;
+    case PROP_SEEK_SNAP:
+      g_value_set_boolean (value, thiz->seek_snap);
+      break;
+    case PROP_QOS_LEVEL:
+      GST_OBJECT_LOCK (thiz);
+      g_value_set_uint (value, gst_egueb_qos_level_get (thiz->qos));
+      GST_OBJECT_UNLOCK (thiz);
+      break;
+    case PROP_QOS_MAX_LEVEL:
+      g_value_set_uint (value, thiz->qos_max_level);
+      break;
+    case PROP_SKIP_LATE:
+      g_value_set_boolean (value, thiz->skip_late);
+      break;
+    case PROP_STILL_MODE:
+      g_value_set_enum (value, thiz->still_mode);
+      break;
+    case PROP_IS_LIVE:
+      g_value_set_boolean (value, gst_base_src_is_live (GST_BASE_SRC (thiz)));
+      break;
+    case PROP_LATENCY:
+      g_value_set_uint64 (value, gst_egueb_src_latency_get (thiz));
+      break;
+    case PROP_INPUT_LATENCY_STATS:
+      g_value_take_boxed (value, gst_egueb_src_input_stats_get (thiz));
+      break;
+    case PROP_FRAMES_DROPPED:
+      GST_OBJECT_LOCK (thiz);
+      g_value_set_uint64 (value, thiz->dropped);
+      GST_OBJECT_UNLOCK (thiz);
+      break;
+    case PROP_VIEWPORT:
+      GST_OBJECT_LOCK (thiz);
+      if (thiz->viewport_set)
+        g_value_take_string (value, g_strdup_printf ("%d,%d,%d,%d",
+            thiz->viewport.x, thiz->viewport.y, thiz->viewport.w,
+            thiz->viewport.h));
+      else
+        g_value_set_string (value, NULL);
+      GST_OBJECT_UNLOCK (thiz);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -709,6 +3105,7 @@ gst_egueb_src_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
   GstEguebSrc * thiz = GST_EGUEB_SRC (object);
+  GList *l;
 
   switch (prop_id) {
     case PROP_XML:
@@ -723,6 +3120,8 @@ gst_egueb_src_set_property (GObject * object, guint prop_id,
     case PROP_BACKGROUND_COLOR:
       enesim_renderer_background_color_set (thiz->background,
           g_value_get_uint (value));
+      gst_egueb_cache_flush (thiz->cache);
+      thiz->store_dirty = TRUE;
       break;
     case PROP_URI:{
       const gchar *location;
@@ -737,6 +3136,89 @@ gst_egueb_src_set_property (GObject * object, guint prop_id,
       }
       break;
     }
+    case PROP_ZERO_COPY:
+      thiz->zero_copy = g_value_get_boolean (value);
+      break;
+    case PROP_MARK_REPEATED:
+      thiz->mark_repeated = g_value_get_boolean (value);
+      break;
+    case PROP_DAMAGE_RECT_COST:
+      thiz->damage_rect_cost = g_value_get_uint (value);
+      break;
+    case PROP_PIPELINE:
+      thiz->pipeline = g_value_get_boolean (value);
+      break;
+    case PROP_PREMULTIPLIED:
+      thiz->premultiplied = g_value_get_boolean (value);
+      thiz->store_dirty = TRUE;
+      break;
+    case PROP_MAX_BUFFERS:
+      thiz->max_buffers = g_value_get_uint (value);
+      gst_egueb_pool_max_set (thiz->pool, thiz->max_buffers);
+      GST_PAD_STREAM_LOCK (GST_BASE_SRC_PAD (thiz));
+      for (l = thiz->renditions; l; l = g_list_next (l)) {
+        GstEguebSrcRendition *r = l->data;
+
+        gst_egueb_pool_max_set (r->pool, thiz->max_buffers);
+      }
+      GST_PAD_STREAM_UNLOCK (GST_BASE_SRC_PAD (thiz));
+      break;
+    case PROP_LOOP_PERIOD:
+      thiz->loop_period = g_value_get_uint64 (value);
+      gst_egueb_cache_flush (thiz->cache);
+      break;
+    case PROP_CACHE_MAX_BYTES:
+      thiz->cache_max_bytes = g_value_get_uint64 (value);
+      gst_egueb_cache_max_set (thiz->cache, thiz->cache_max_bytes);
+      break;
+    case PROP_CACHE_DIR:
+      g_free (thiz->cache_dir);
+      thiz->cache_dir = g_value_dup_string (value);
+      break;
+    case PROP_CACHE_DIR_MAX_BYTES:
+      thiz->cache_dir_max_bytes = g_value_get_uint64 (value);
+      if (thiz->store)
+        gst_egueb_store_max_set (thiz->store, thiz->cache_dir_max_bytes);
+      break;
+    case PROP_SEEK_SNAP:
+      thiz->seek_snap = g_value_get_boolean (value);
+      break;
+    case PROP_QOS_MAX_LEVEL:
+      thiz->qos_max_level = g_value_get_uint (value);
+      GST_OBJECT_LOCK (thiz);
+      gst_egueb_qos_max_set (thiz->qos, thiz->qos_max_level);
+      GST_OBJECT_UNLOCK (thiz);
+      break;
+    case PROP_SKIP_LATE:
+      thiz->skip_late = g_value_get_boolean (value);
+      break;
+    case PROP_STILL_MODE:
+      thiz->still_mode = g_value_get_enum (value);
+      break;
+    case PROP_IS_LIVE:
+      gst_base_src_set_live (GST_BASE_SRC (thiz), g_value_get_boolean (value));
+      break;
+    case PROP_VIEWPORT:{
+      const gchar *viewport;
+      gint x, y, w, h;
+
+      viewport = g_value_get_string (value);
+      GST_OBJECT_LOCK (thiz);
+      if (!viewport || !*viewport) {
+        thiz->viewport_set = FALSE;
+      } else if (sscanf (viewport, "%d,%d,%d,%d", &x, &y, &w, &h) == 4 &&
+          w > 0 && h > 0) {
+        eina_rectangle_coords_from (&thiz->viewport, x, y, w, h);
+        thiz->viewport_set = TRUE;
+      } else {
+        GST_WARNING_OBJECT (thiz, "Invalid viewport '%s'", viewport);
+        GST_OBJECT_UNLOCK (thiz);
+        break;
+      }
+      thiz->viewport_changed = TRUE;
+      GST_OBJECT_UNLOCK (thiz);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -771,6 +3253,11 @@ gst_egueb_src_change_state (GstElement * element, GstStateChange transition)
   ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
 
   switch (transition) {
+    /* the streaming thread is stopped now */
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_egueb_src_pipeline_stop (thiz);
+      break;
+
     default:
       break;
   }
@@ -785,12 +3272,74 @@ gst_egueb_src_dispose (GObject * object)
   GstEguebSrc *thiz = GST_EGUEB_SRC (object);
 
   GST_DEBUG_OBJECT (thiz, "Disposing");
+  gst_egueb_src_pipeline_stop (thiz);
   gst_egueb_src_cleanup (thiz);
 
   enesim_renderer_unref(thiz->background);
 
+  if (thiz->pool) {
+    gst_egueb_pool_free (thiz->pool);
+    thiz->pool = NULL;
+  }
+
+  if (thiz->cache) {
+    gst_egueb_cache_free (thiz->cache);
+    thiz->cache = NULL;
+  }
+
+  if (thiz->step) {
+    gst_event_unref (thiz->step);
+    thiz->step = NULL;
+  }
+
+  if (thiz->step_done) {
+    gst_message_unref (thiz->step_done);
+    thiz->step_done = NULL;
+  }
+
+  if (thiz->qos) {
+    gst_egueb_qos_free (thiz->qos);
+    thiz->qos = NULL;
+  }
+
+  if (thiz->latency) {
+    gst_egueb_latency_free (thiz->latency);
+    thiz->latency = NULL;
+  }
+
+  if (thiz->navigation) {
+    gst_egueb_navigation_free (thiz->navigation);
+    thiz->navigation = NULL;
+  }
+
+  if (thiz->input_applied) {
+    g_array_free (thiz->input_applied, TRUE);
+    thiz->input_applied = NULL;
+  }
+
+  if (thiz->input_ready) {
+    g_array_free (thiz->input_ready, TRUE);
+    thiz->input_ready = NULL;
+  }
+
+  if (thiz->input_latency) {
+    gst_egueb_latency_free (thiz->input_latency);
+    thiz->input_latency = NULL;
+  }
+
+  g_list_foreach (thiz->renditions, (GFunc) gst_egueb_src_rendition_free,
+      NULL);
+  g_list_free (thiz->renditions);
+  thiz->renditions = NULL;
+
   if (thiz->doc_lock)
     g_mutex_free (thiz->doc_lock);
+  if (thiz->pipeline_lock)
+    g_mutex_free (thiz->pipeline_lock);
+  if (thiz->pipeline_cond)
+    g_cond_free (thiz->pipeline_cond);
+  if (thiz->still_cond)
+    g_cond_free (thiz->still_cond);
   GST_CALL_PARENT (G_OBJECT_CLASS, dispose, (object));
 
   egueb_smil_shutdown ();
@@ -805,10 +3354,14 @@ gst_egueb_src_base_init (gpointer g_class)
 
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&gst_egueb_src_src_factory));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&gst_egueb_src_video_factory));
   gst_element_class_set_details (element_class, &gst_egueb_src_details);
 
   /* set virtual pointers */
   base_class->create = gst_egueb_src_create;
+  base_class->unlock = gst_egueb_src_unlock;
+  base_class->unlock_stop = gst_egueb_src_unlock_stop;
   base_class->set_caps = gst_egueb_src_set_caps;
   base_class->get_caps = gst_egueb_src_get_caps;
   base_class->fixate = gst_egueb_src_fixate;
@@ -828,6 +3381,9 @@ gst_egueb_src_init (GstEguebSrc * thiz,
   /* make it work in time */
   gst_base_src_set_format (GST_BASE_SRC (thiz), GST_FORMAT_TIME);
   thiz->doc_lock = g_mutex_new ();
+  thiz->pipeline_lock = g_mutex_new ();
+  thiz->pipeline_cond = g_cond_new ();
+  thiz->still_cond = g_cond_new ();
   /* initial seek segment position */
   thiz->seek = GST_CLOCK_TIME_NONE;
   thiz->last_ts = 0;
@@ -835,6 +3391,32 @@ gst_egueb_src_init (GstEguebSrc * thiz,
   /* set default properties */
   thiz->container_w = 256;
   thiz->container_h = 256;
+  thiz->damage_rect_cost = DEFAULT_DAMAGE_RECT_COST;
+  thiz->format = GST_VIDEO_FORMAT_BGRx;
+  thiz->max_buffers = DEFAULT_MAX_BUFFERS;
+  thiz->pool = gst_egueb_pool_new ();
+  gst_egueb_pool_max_set (thiz->pool, thiz->max_buffers);
+  thiz->cache_max_bytes = DEFAULT_CACHE_MAX_BYTES;
+  thiz->cache = gst_egueb_cache_new ();
+  gst_egueb_cache_max_set (thiz->cache, thiz->cache_max_bytes);
+  thiz->cache_dir_max_bytes = DEFAULT_CACHE_DIR_MAX_BYTES;
+  thiz->scale = 1;
+  thiz->qos_max_level = DEFAULT_QOS_MAX_LEVEL;
+  thiz->skip_late = DEFAULT_SKIP_LATE;
+  thiz->earliest = GST_CLOCK_TIME_NONE;
+  thiz->still_mode = DEFAULT_STILL_MODE;
+  thiz->latency = gst_egueb_latency_new (LATENCY_SAMPLES);
+  thiz->navigation = gst_egueb_navigation_new (NAVIGATION_EVENTS);
+  thiz->input_applied = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  thiz->input_ready = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  thiz->input_latency = gst_egueb_latency_new (LATENCY_SAMPLES);
+  gst_egueb_src_input_stats_reset (thiz);
+  gst_pad_add_buffer_probe (GST_BASE_SRC_PAD (thiz),
+      G_CALLBACK (gst_egueb_src_buffer_probe), thiz);
+  thiz->latency_reported = GST_CLOCK_TIME_NONE;
+  thiz->latency_configured = GST_CLOCK_TIME_NONE;
+  thiz->qos = gst_egueb_qos_new ();
+  gst_egueb_qos_max_set (thiz->qos, thiz->qos_max_level);
   thiz->background = enesim_renderer_background_new();
   enesim_renderer_background_color_set (thiz->background, 0xffffffff);
 }
@@ -855,6 +3437,10 @@ gst_egueb_src_class_init (GstEguebSrcClass * klass)
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_egueb_src_change_state);
+  gstelement_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_egueb_src_request_new_pad);
+  gstelement_class->release_pad =
+      GST_DEBUG_FUNCPTR (gst_egueb_src_release_pad);
 
   /* Properties */
   g_object_class_install_property (gobject_class, PROP_XML,
@@ -877,4 +3463,112 @@ gst_egueb_src_class_init (GstEguebSrcClass * klass)
       g_param_spec_uint ("background-color", "Background Color",
           "Background color to use (big-endian ARGB)", 0, G_MAXUINT32,
           0, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_ZERO_COPY,
+      g_param_spec_boolean ("zero-copy", "Zero copy",
+          "Render directly on the downstream buffers instead of converting "
+          "from an intermediate surface", FALSE, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_MARK_REPEATED,
+      g_param_spec_boolean ("mark-repeated", "Mark repeated",
+          "Flag the frames without changes as gap buffers so encoders "
+          "can skip them", FALSE, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_DAMAGE_RECT_COST,
+      g_param_spec_uint ("damage-rect-cost", "Damage rectangle cost",
+          "Cost of drawing one more damaged rectangle, in pixels. Damages "
+          "are fused when the extra pixels drawn cost less", 0, G_MAXUINT,
+          DEFAULT_DAMAGE_RECT_COST, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_DAMAGE_PIXELS,
+      g_param_spec_uint64 ("damage-pixels", "Damage pixels",
+          "Number of damaged pixels reported by the document", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE));
+  g_object_class_install_property (gobject_class, PROP_DAMAGE_PIXELS_SAVED,
+      g_param_spec_int64 ("damage-pixels-saved", "Damage pixels saved",
+          "Number of pixels not drawn thanks to fusing the damages",
+          G_MININT64, G_MAXINT64, 0, G_PARAM_READABLE));
+  g_object_class_install_property (gobject_class, PROP_PIPELINE,
+      g_param_spec_boolean ("pipeline", "Pipeline",
+          "Draw the next frame on a separate thread while the current one is "
+          "converted. Zero-copy is not used in this mode", FALSE,
+          G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_LOOP_PERIOD,
+      g_param_spec_uint64 ("loop-period", "Loop period",
+          "Period in nanoseconds after which the document repeats itself. "
+          "The frames of one period are cached and pushed again on the next "
+          "ones (0 = disabled)", 0, G_MAXUINT64, 0, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_CACHE_MAX_BYTES,
+      g_param_spec_uint64 ("cache-max-bytes", "Cache max bytes",
+          "Maximum memory used by the cached frames of a loop period",
+          0, G_MAXUINT64, DEFAULT_CACHE_MAX_BYTES, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_CACHE_HITS,
+      g_param_spec_uint64 ("cache-hits", "Cache hits",
+          "Number of frames taken from the loop period cache", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE));
+  g_object_class_install_property (gobject_class, PROP_CACHE_MISSES,
+      g_param_spec_uint64 ("cache-misses", "Cache misses",
+          "Number of frames of a loop period that had to be rendered", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE));
+  g_object_class_install_property (gobject_class, PROP_CACHE_DIR,
+      g_param_spec_string ("cache-dir", "Cache directory",
+          "Directory where the rendered frames are kept between runs, "
+          "keyed by the document, the output and the timestamp",
+          NULL, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_CACHE_DIR_MAX_BYTES,
+      g_param_spec_uint64 ("cache-dir-max-bytes", "Cache directory max bytes",
+          "Maximum size of the frames on the cache directory, the least "
+          "recently used are removed first (0 = unlimited)", 0, G_MAXUINT64,
+          DEFAULT_CACHE_DIR_MAX_BYTES, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_SEEK_SNAP,
+      g_param_spec_boolean ("seek-snap", "Seek snap",
+          "Move the position of every seek to the nearest frame boundary",
+          FALSE, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_QOS_LEVEL,
+      g_param_spec_uint ("qos-level", "QoS level",
+          "Current degradation because of QoS (0 = none, 1 = skip every "
+          "other frame, 2 = half resolution, 3 = both)", 0,
+          GST_EGUEB_QOS_LEVELS - 1, 0, G_PARAM_READABLE));
+  g_object_class_install_property (gobject_class, PROP_QOS_MAX_LEVEL,
+      g_param_spec_uint ("qos-max-level", "QoS max level",
+          "Maximum degradation allowed when downstream is late "
+          "(0 = never degrade)", 0, GST_EGUEB_QOS_LEVELS - 1,
+          DEFAULT_QOS_MAX_LEVEL, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_SKIP_LATE,
+      g_param_spec_boolean ("skip-late", "Skip late",
+          "Do not process nor draw the frames that would arrive late "
+          "downstream", DEFAULT_SKIP_LATE, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_FRAMES_DROPPED,
+      g_param_spec_uint64 ("frames-dropped", "Frames dropped",
+          "Number of frames skipped because they were late", 0, G_MAXUINT64,
+          0, G_PARAM_READABLE));
+  g_object_class_install_property (gobject_class, PROP_STILL_MODE,
+      g_param_spec_enum ("still-mode", "Still mode",
+          "What to send after the frame of a document without animations",
+          GST_TYPE_EGUEB_SRC_STILL_MODE, DEFAULT_STILL_MODE,
+          G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_IS_LIVE,
+      g_param_spec_boolean ("is-live", "Is live",
+          "Draw every frame at its running time against the pipeline clock",
+          DEFAULT_IS_LIVE, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_LATENCY,
+      g_param_spec_uint64 ("latency", "Latency",
+          "Time needed to process, draw and convert a frame, as reported "
+          "to the pipeline in live mode", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE));
+  g_object_class_install_property (gobject_class, PROP_INPUT_LATENCY_STATS,
+      g_param_spec_boxed ("input-latency-stats", "Input latency stats",
+          "Time from a navigation event to the first buffer showing it "
+          "being pushed: number of events, min, max, percentiles and "
+          "histogram", GST_TYPE_STRUCTURE, G_PARAM_READABLE));
+  g_object_class_install_property (gobject_class, PROP_PREMULTIPLIED,
+      g_param_spec_boolean ("premultiplied", "Premultiplied",
+          "Whether the ARGB output has the color premultiplied by the alpha, "
+          "straight alpha otherwise", FALSE, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_MAX_BUFFERS,
+      g_param_spec_uint ("max-buffers", "Max buffers",
+          "Maximum number of own buffers kept for reuse when downstream "
+          "can not allocate them", 0, G_MAXUINT, DEFAULT_MAX_BUFFERS,
+          G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_VIEWPORT,
+      g_param_spec_string ("viewport", "Viewport",
+          "Area of the document to output as \"x,y,width,height\" on "
+          "document coordinates, it can be moved while playing",
+          NULL, G_PARAM_READWRITE));
 }
@@ -5,11 +5,19 @@
 #include <gst/base/gstadapter.h>
 #include <gst/base/gstbasesrc.h>
 #include <gst/interfaces/navigation.h>
+#include <gst/video/video.h>
 
 #include <Egueb_Dom.h>
 #include <Egueb_Smil.h>
 
 #include "gst_egueb_document.h"
+#include "gst_egueb_pool.h"
+#include "gst_egueb_cache.h"
+#include "gst_egueb_store.h"
+#include "gst_egueb_qos.h"
+#include "gst_egueb_latency.h"
+#include "gst_egueb_navigation.h"
+#include "gst_egueb_coverage.h"
 
 G_BEGIN_DECLS
 
@@ -27,6 +35,19 @@ G_BEGIN_DECLS
 typedef struct _GstEguebSrc GstEguebSrc;
 typedef struct _GstEguebSrcClass GstEguebSrcClass;
 
+/* the latencies from an input event to the frame showing it are counted
+ * on this number of ranges
+ */
+#define GST_EGUEB_SRC_INPUT_BUCKETS 8
+
+/* what to do once the frame of a document without animations is sent */
+typedef enum
+{
+  GST_EGUEB_SRC_STILL_MODE_EOS,
+  GST_EGUEB_SRC_STILL_MODE_REPEAT,
+  GST_EGUEB_SRC_STILL_MODE_STILL,
+} GstEguebSrcStillMode;
+
 struct _GstEguebSrc
 {
   GstBaseSrc parent;
@@ -35,6 +56,24 @@ struct _GstEguebSrc
   guint container_w;
   guint container_h;
   gchar *location;
+  gboolean zero_copy;
+  gboolean mark_repeated;
+  guint damage_rect_cost;
+  gboolean pipeline;
+  gboolean premultiplied;
+  guint max_buffers;
+  /* the part of the document to output, on document coordinates */
+  Eina_Rectangle viewport;
+  gboolean viewport_set;
+  gboolean viewport_changed;
+  guint64 loop_period;
+  guint64 cache_max_bytes;
+  gchar *cache_dir;
+  guint64 cache_dir_max_bytes;
+  gboolean seek_snap;
+  guint qos_max_level;
+  gboolean skip_late;
+  GstEguebSrcStillMode still_mode;
   /* private */
   Egueb_Dom_Node *doc;
   Egueb_Dom_Node *topmost;
@@ -50,17 +89,97 @@ struct _GstEguebSrc
   GMutex *doc_lock;
   Enesim_Surface *s;
   Enesim_Renderer *background;
+  Gst_Egueb_Coverage *coverage;
   Eina_List *damages;
+  guint64 damage_pixels;
+  gint64 damage_pixels_saved;
+  gboolean damage_all;
+  GstBuffer *last;
+  /* the last frame was drawn, not repeated */
+  gboolean last_drawn;
+  Gst_Egueb_Pool *pool;
+  Gst_Egueb_Cache *cache;
+  guint64 cache_hits;
+  guint64 cache_misses;
+  Gst_Egueb_Store *store;
+  gboolean store_dirty;
+  /* the document no longer follows its own timeline */
+  gboolean diverged;
+  Gst_Egueb_Qos *qos;
+  /* the document is drawn at a fraction of the size */
+  gint scale;
+  Enesim_Surface *small;
+  /* the running time downstream can still show, from the QoS events */
+  GstClockTime earliest;
+  guint64 processed;
+  guint64 dropped;
+  /* a frame has been sent since the last seek */
+  gboolean frame_sent;
+  gboolean still_unlock;
+  gboolean still_wake;
+  GCond *still_cond;
+  /* the input events not given to the document yet */
+  Gst_Egueb_Navigation *navigation;
+  /* the stamps of the events fed to the document but not drawn yet, and
+   * the ones drawn on the buffer about to be pushed
+   */
+  GArray *input_applied;
+  GArray *input_ready;
+  Gst_Egueb_Latency *input_latency;
+  guint64 input_events;
+  GstClockTime input_min;
+  GstClockTime input_max;
+  guint64 input_histogram[GST_EGUEB_SRC_INPUT_BUCKETS];
+  /* live mode */
+  GstClockID clock_id;
+  Gst_Egueb_Latency *latency;
+  /* the samples added since the percentile was computed */
+  guint latency_samples;
+  GstClockTime latency_reported;
+  /* the latency of the whole pipeline, from the latency event */
+  GstClockTime latency_configured;
+  /* the request pads */
+  GList *renditions;
+  guint renditions_count;
   gboolean done;
-
+  /* pipelined rendering */
+  GThread *render_thread;
+  GMutex *pipeline_lock;
+  GCond *pipeline_cond;
+  gboolean pipeline_running;
+  struct _GstEguebSrcFrame *frame;
+  Enesim_Surface *surfaces[2];
+  Eina_List *pending[2];
+  gint back;
+  guint64 render_ts;
+  gint64 render_frame;
+
+  GstVideoFormat format;
   guint w;
   guint h;
+  /* the viewport in use by the streaming thread */
+  gboolean roi;
+  gint roi_x;
+  gint roi_y;
+  gint content_w;
+  gint content_h;
   gint spf_n;
   gint spf_d;
 
   gint64 last_stop;
   guint64 seek;
+  gboolean seek_flush;
+  /* a reverse segment has reached its start */
+  gboolean segment_done;
+  GstEvent *step;
+  /* posted once the frame the step ends at is pushed */
+  GstMessage *step_done;
   guint64 last_ts;
+  /* the timestamps are counted in frames from the last position set, so
+   * the rounding of the duration does not accumulate
+   */
+  guint64 position_base;
+  gint64 position_frame;
   gint64 duration;
   gint64 fps;
 };
@@ -0,0 +1,477 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <utime.h>
+
+#include <gst/gst.h>
+#include <glib/gstdio.h>
+
+#include "gst_egueb_store.h"
+
+GST_DEBUG_CATEGORY_EXTERN (gst_egueb_src_debug);
+#define GST_CAT_DEFAULT gst_egueb_src_debug
+
+/* Every frame is a file on the directory named after the hash of the
+ * document and the timestamp of the frame. The file has a fixed header
+ * followed by the data of the buffer, so the buffer can be mapped directly
+ * from the file. The modification time of the files is updated on every
+ * use and the oldest ones are removed once the directory grows beyond the
+ * maximum. The files are written on a thread of their own, if it can not
+ * keep up the new frames are not stored. The directory is only read once,
+ * from then on an index in memory tells what is stored, frames written by
+ * other processes later on are not known
+ */
+#define STORE_MAGIC "EGUEBFRM"
+#define STORE_VERSION 1
+#define STORE_HEADER_SIZE 64
+#define STORE_SUFFIX ".frame"
+#define STORE_QUEUE_MAX 8
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+typedef struct _Gst_Egueb_Store_Header
+{
+	gchar magic[8];
+	guint32 version;
+	guint32 size;
+} Gst_Egueb_Store_Header;
+
+typedef struct _Gst_Egueb_Store_Map
+{
+	gpointer addr;
+	gsize size;
+} Gst_Egueb_Store_Map;
+
+typedef struct _Gst_Egueb_Store_Entry
+{
+	gchar *path;
+	/* the higher the more recently used */
+	guint64 used;
+	guint64 size;
+} Gst_Egueb_Store_Entry;
+
+/* a frame waiting to be written */
+typedef struct _Gst_Egueb_Store_Write
+{
+	gchar *path;
+	GstBuffer *buffer;
+} Gst_Egueb_Store_Write;
+
+struct _Gst_Egueb_Store
+{
+	gchar *dir;
+	gchar *document;
+	GThreadPool *writer;
+	/* the index, the size and the maximum are shared with the writer */
+	GMutex *lock;
+	/* the frames on the directory by their path */
+	GHashTable *entries;
+	guint64 used;
+	/* the size of every frame on the directory */
+	guint64 size;
+	guint64 max;
+};
+
+static void _gst_egueb_store_map_free(gpointer data)
+{
+	Gst_Egueb_Store_Map *map = data;
+
+	munmap(map->addr, map->size);
+	g_free(map);
+}
+
+static gchar * _gst_egueb_store_path_get(Gst_Egueb_Store *thiz,
+		GstClockTime ts)
+{
+	gchar *name;
+	gchar *path;
+
+	name = g_strdup_printf("%s-%" G_GUINT64_FORMAT STORE_SUFFIX,
+			thiz->document, ts);
+	path = g_build_filename(thiz->dir, name, NULL);
+	g_free(name);
+
+	return path;
+}
+
+static gint _gst_egueb_store_entry_cmp(gconstpointer a, gconstpointer b)
+{
+	const Gst_Egueb_Store_Entry *ea = a;
+	const Gst_Egueb_Store_Entry *eb = b;
+
+	if (ea->used < eb->used)
+		return -1;
+	return ea->used > eb->used;
+}
+
+static void _gst_egueb_store_entry_free(gpointer data)
+{
+	Gst_Egueb_Store_Entry *e = data;
+
+	g_free(e->path);
+	g_free(e);
+}
+
+/* must be called with the lock held */
+static void _gst_egueb_store_entry_add(Gst_Egueb_Store *thiz,
+		gchar *path, guint64 size)
+{
+	Gst_Egueb_Store_Entry *e;
+
+	e = g_hash_table_lookup(thiz->entries, path);
+	if (e)
+	{
+		thiz->size -= e->size;
+		g_free(path);
+	}
+	else
+	{
+		e = g_new(Gst_Egueb_Store_Entry, 1);
+		e->path = path;
+		g_hash_table_insert(thiz->entries, e->path, e);
+	}
+	e->used = ++thiz->used;
+	e->size = size;
+	thiz->size += size;
+}
+
+/* must be called with the lock held */
+static void _gst_egueb_store_entry_remove(Gst_Egueb_Store *thiz,
+		const gchar *path)
+{
+	Gst_Egueb_Store_Entry *e;
+
+	e = g_hash_table_lookup(thiz->entries, path);
+	if (!e)
+		return;
+	thiz->size -= e->size;
+	g_hash_table_remove(thiz->entries, path);
+}
+
+/* fill the index with what is already on the directory, the oldest
+ * modified frames are the least recently used ones
+ */
+static void _gst_egueb_store_index(Gst_Egueb_Store *thiz)
+{
+	GDir *dir;
+	GList *entries = NULL;
+	GList *l;
+	const gchar *name;
+
+	dir = g_dir_open(thiz->dir, 0, NULL);
+	if (!dir)
+		return;
+
+	while ((name = g_dir_read_name(dir)))
+	{
+		Gst_Egueb_Store_Entry *e;
+		struct stat st;
+		gchar *path;
+
+		if (!g_str_has_suffix(name, STORE_SUFFIX))
+			continue;
+		path = g_build_filename(thiz->dir, name, NULL);
+		if (g_stat(path, &st) < 0)
+		{
+			g_free(path);
+			continue;
+		}
+		e = g_new(Gst_Egueb_Store_Entry, 1);
+		e->path = path;
+		e->used = st.st_mtime;
+		e->size = st.st_size;
+		entries = g_list_prepend(entries, e);
+	}
+	g_dir_close(dir);
+
+	entries = g_list_sort(entries, _gst_egueb_store_entry_cmp);
+	for (l = entries; l; l = g_list_next(l))
+	{
+		Gst_Egueb_Store_Entry *e = l->data;
+
+		_gst_egueb_store_entry_add(thiz, e->path, e->size);
+		g_free(e);
+	}
+	g_list_free(entries);
+}
+
+/* remove the least recently used frames, leave some room to not do it on
+ * every new frame
+ */
+static void _gst_egueb_store_evict(Gst_Egueb_Store *thiz)
+{
+	GList *entries;
+	GList *l;
+	guint64 keep;
+
+	keep = thiz->max - thiz->max / 8;
+	entries = g_hash_table_get_values(thiz->entries);
+	entries = g_list_sort(entries, _gst_egueb_store_entry_cmp);
+	for (l = entries; l && thiz->size > keep; l = g_list_next(l))
+	{
+		Gst_Egueb_Store_Entry *e = l->data;
+
+		/* another process might have removed it already */
+		g_unlink(e->path);
+		GST_LOG("Evicted '%s'", e->path);
+		_gst_egueb_store_entry_remove(thiz, e->path);
+	}
+	g_list_free(entries);
+}
+
+static void _gst_egueb_store_write(gpointer data, gpointer user_data)
+{
+	Gst_Egueb_Store *thiz = user_data;
+	Gst_Egueb_Store_Write *w = data;
+	Gst_Egueb_Store_Header header;
+	guint8 padding[STORE_HEADER_SIZE - sizeof(Gst_Egueb_Store_Header)];
+	GstBuffer *buffer = w->buffer;
+	gboolean stored;
+	gchar *tmp = NULL;
+	gint fd;
+
+	/* already stored, like before a seek */
+	g_mutex_lock(thiz->lock);
+	stored = g_hash_table_lookup(thiz->entries, w->path) != NULL;
+	g_mutex_unlock(thiz->lock);
+	if (stored)
+		goto done;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, STORE_MAGIC, sizeof(header.magic));
+	header.version = STORE_VERSION;
+	header.size = GST_BUFFER_SIZE(buffer);
+	memset(padding, 0, sizeof(padding));
+
+	/* write it somewhere else, so nobody maps a partial frame. Other
+	 * processes might be writing the same frame, the name must be unique
+	 */
+	tmp = g_strdup_printf("%s.XXXXXX", w->path);
+	fd = g_mkstemp(tmp);
+	if (fd < 0)
+		goto done;
+	fchmod(fd, 0644);
+
+	if (write(fd, &header, sizeof(header)) != sizeof(header) ||
+			write(fd, padding, sizeof(padding)) != sizeof(padding) ||
+			write(fd, GST_BUFFER_DATA(buffer), GST_BUFFER_SIZE(buffer)) !=
+			(gssize)GST_BUFFER_SIZE(buffer))
+	{
+		GST_WARNING("Impossible to write the frame '%s'", w->path);
+		close(fd);
+		g_unlink(tmp);
+		goto done;
+	}
+	close(fd);
+
+	if (g_rename(tmp, w->path) < 0)
+	{
+		g_unlink(tmp);
+		goto done;
+	}
+
+	g_mutex_lock(thiz->lock);
+	_gst_egueb_store_entry_add(thiz, w->path,
+			STORE_HEADER_SIZE + GST_BUFFER_SIZE(buffer));
+	w->path = NULL;
+	if (thiz->max && thiz->size > thiz->max)
+		_gst_egueb_store_evict(thiz);
+	g_mutex_unlock(thiz->lock);
+done:
+	g_free(tmp);
+	g_free(w->path);
+	gst_buffer_unref(buffer);
+	g_free(w);
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+Gst_Egueb_Store * gst_egueb_store_new(const gchar *dir)
+{
+	Gst_Egueb_Store *thiz;
+
+	if (g_mkdir_with_parents(dir, 0755) < 0)
+	{
+		GST_WARNING("Impossible to create the directory '%s'", dir);
+		return NULL;
+	}
+
+	thiz = g_new0(Gst_Egueb_Store, 1);
+	thiz->dir = g_strdup(dir);
+	thiz->lock = g_mutex_new();
+	thiz->entries = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+			_gst_egueb_store_entry_free);
+	/* a single thread, the frames are written one after the other */
+	thiz->writer = g_thread_pool_new(_gst_egueb_store_write, thiz, 1,
+			FALSE, NULL);
+	_gst_egueb_store_index(thiz);
+	GST_DEBUG("Using '%s' with %" G_GUINT64_FORMAT " bytes of frames", dir,
+			thiz->size);
+
+	return thiz;
+}
+
+void gst_egueb_store_free(Gst_Egueb_Store *thiz)
+{
+	/* finish the pending writes */
+	g_thread_pool_free(thiz->writer, FALSE, TRUE);
+	g_hash_table_destroy(thiz->entries);
+	g_mutex_free(thiz->lock);
+	g_free(thiz->document);
+	g_free(thiz->dir);
+	g_free(thiz);
+}
+
+void gst_egueb_store_max_set(Gst_Egueb_Store *thiz, guint64 max)
+{
+	g_mutex_lock(thiz->lock);
+	thiz->max = max;
+	if (max && thiz->size > max)
+		_gst_egueb_store_evict(thiz);
+	g_mutex_unlock(thiz->lock);
+}
+
+/* everything that changes the content of the frames must be on the
+ * description. The same document can be somewhere else with other
+ * resources relative to it, so its location is part of the key too
+ */
+void gst_egueb_store_document_set(Gst_Egueb_Store *thiz, GstBuffer *xml,
+		const gchar *uri, const gchar *description)
+{
+	GChecksum *checksum;
+
+	checksum = g_checksum_new(G_CHECKSUM_SHA1);
+	g_checksum_update(checksum, GST_BUFFER_DATA(xml), GST_BUFFER_SIZE(xml));
+	if (uri)
+		g_checksum_update(checksum, (const guchar *)uri,
+				strlen(uri) + 1);
+	g_checksum_update(checksum, (const guchar *)description,
+			strlen(description));
+	g_free(thiz->document);
+	thiz->document = g_strdup(g_checksum_get_string(checksum));
+	g_checksum_free(checksum);
+	GST_DEBUG("Document hash is %s for %s", thiz->document, description);
+}
+
+GstBuffer * gst_egueb_store_get(Gst_Egueb_Store *thiz, GstClockTime ts)
+{
+	Gst_Egueb_Store_Header *header;
+	Gst_Egueb_Store_Map *map;
+	Gst_Egueb_Store_Entry *e;
+	GstBuffer *buffer;
+	struct stat st;
+	gpointer addr;
+	gchar *path;
+	gint fd;
+
+	if (!thiz->document)
+		return NULL;
+
+	/* only touch the directory for the frames we know are there */
+	path = _gst_egueb_store_path_get(thiz, ts);
+	g_mutex_lock(thiz->lock);
+	e = g_hash_table_lookup(thiz->entries, path);
+	if (e)
+		e->used = ++thiz->used;
+	g_mutex_unlock(thiz->lock);
+	if (!e)
+	{
+		g_free(path);
+		return NULL;
+	}
+
+	fd = g_open(path, O_RDONLY, 0);
+	if (fd < 0)
+		goto removed;
+
+	if (fstat(fd, &st) < 0 || st.st_size < STORE_HEADER_SIZE)
+		goto invalid;
+
+	/* a private mapping, whoever writes on the buffer gets its own copy of
+	 * the page
+	 */
+	addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fd, 0);
+	if (addr == MAP_FAILED)
+		goto invalid;
+
+	header = addr;
+	if (memcmp(header->magic, STORE_MAGIC, sizeof(header->magic)) ||
+			header->version != STORE_VERSION ||
+			header->size != st.st_size - STORE_HEADER_SIZE)
+	{
+		munmap(addr, st.st_size);
+		goto invalid;
+	}
+	close(fd);
+
+	/* keep it as recently used */
+	g_utime(path, NULL);
+	g_free(path);
+
+	map = g_new(Gst_Egueb_Store_Map, 1);
+	map->addr = addr;
+	map->size = st.st_size;
+
+	buffer = gst_buffer_new();
+	GST_BUFFER_DATA(buffer) = (guint8 *)addr + STORE_HEADER_SIZE;
+	GST_BUFFER_SIZE(buffer) = header->size;
+	GST_BUFFER_MALLOCDATA(buffer) = (guint8 *)map;
+	GST_BUFFER_FREE_FUNC(buffer) = _gst_egueb_store_map_free;
+
+	return buffer;
+
+invalid:
+	GST_WARNING("Invalid frame '%s'", path);
+	close(fd);
+	g_unlink(path);
+removed:
+	g_mutex_lock(thiz->lock);
+	_gst_egueb_store_entry_remove(thiz, path);
+	g_mutex_unlock(thiz->lock);
+	g_free(path);
+	return NULL;
+}
+
+/* the buffer is written later, its data must not change anymore */
+void gst_egueb_store_add(Gst_Egueb_Store *thiz, GstClockTime ts,
+		GstBuffer *buffer)
+{
+	Gst_Egueb_Store_Write *w;
+
+	if (!thiz->document)
+		return;
+
+	if (g_thread_pool_unprocessed(thiz->writer) >= STORE_QUEUE_MAX)
+	{
+		GST_LOG("Too many frames to write, skipping the one at %"
+				GST_TIME_FORMAT, GST_TIME_ARGS(ts));
+		return;
+	}
+
+	w = g_new(Gst_Egueb_Store_Write, 1);
+	w->path = _gst_egueb_store_path_get(thiz, ts);
+	w->buffer = gst_buffer_ref(buffer);
+	g_thread_pool_push(thiz->writer, w, NULL);
+}
@@ -0,0 +1,35 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GST_EGUEB_STORE_H_
+#define _GST_EGUEB_STORE_H_
+
+#include <gst/gst.h>
+
+typedef struct _Gst_Egueb_Store Gst_Egueb_Store;
+
+Gst_Egueb_Store * gst_egueb_store_new(const gchar *dir);
+void gst_egueb_store_free(Gst_Egueb_Store *thiz);
+void gst_egueb_store_max_set(Gst_Egueb_Store *thiz, guint64 max);
+void gst_egueb_store_document_set(Gst_Egueb_Store *thiz, GstBuffer *xml,
+		const gchar *uri, const gchar *description);
+GstBuffer * gst_egueb_store_get(Gst_Egueb_Store *thiz, GstClockTime ts);
+void gst_egueb_store_add(Gst_Egueb_Store *thiz, GstClockTime ts,
+		GstBuffer *buffer);
+
+#endif
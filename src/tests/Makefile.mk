@@ -0,0 +1,28 @@
+check_PROGRAMS += src/tests/gst_egueb_converter_check
+
+src_tests_gst_egueb_converter_check_CPPFLAGS = \
+-I$(top_srcdir)/src/modules \
+$(GST_EGUEB_MODULES_CFLAGS)
+
+src_tests_gst_egueb_converter_check_SOURCES = \
+src/tests/gst_egueb_converter_check.c \
+src/modules/gst_egueb_converter.c
+
+src_tests_gst_egueb_converter_check_LDADD = \
+$(GST_EGUEB_MODULES_LIBS)
+
+TESTS += src/tests/gst_egueb_converter_check
+
+check_PROGRAMS += src/tests/gst_egueb_src_still_check
+
+src_tests_gst_egueb_src_still_check_CPPFLAGS = \
+-DGST_EGUEB_PLUGIN=\"$(abs_top_builddir)/src/modules/.libs/libgstegueb.so\" \
+$(GST_EGUEB_MODULES_CFLAGS)
+
+src_tests_gst_egueb_src_still_check_SOURCES = \
+src/tests/gst_egueb_src_still_check.c
+
+src_tests_gst_egueb_src_still_check_LDADD = \
+$(GST_EGUEB_MODULES_LIBS)
+
+TESTS += src/tests/gst_egueb_src_still_check
@@ -0,0 +1,221 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Check that every SIMD kernel of the converter the CPU can run gives
+ * exactly the same bytes as the C one. The surfaces are random, with odd
+ * sizes and areas, so the tails and unaligned rows are exercised too
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <Enesim.h>
+
+#include "gst_egueb_converter.h"
+
+#define CHECK_WIDTH_MAX 67
+#define CHECK_HEIGHT_MAX 7
+#define CHECK_AREAS 8
+
+static const gchar *kernels[] = {
+	"sse2",
+	"ssse3",
+	"avx2",
+};
+
+static const GstVideoFormat formats[] = {
+	GST_VIDEO_FORMAT_BGRx,
+	GST_VIDEO_FORMAT_BGRA,
+	GST_VIDEO_FORMAT_I420,
+	GST_VIDEO_FORMAT_NV12,
+	GST_VIDEO_FORMAT_YUY2,
+};
+
+static Enesim_Surface * surface_random(GRand *rand, gint w, gint h)
+{
+	Enesim_Surface *s;
+	guint8 *data;
+	size_t stride;
+	gint x, y;
+
+	s = enesim_surface_new(ENESIM_FORMAT_ARGB8888, w, h);
+	enesim_surface_data_get(s, (void **)&data, &stride);
+	for (y = 0; y < h; y++)
+	{
+		guint32 *row = (guint32 *)(data + (y * stride));
+
+		for (x = 0; x < w; x++)
+		{
+			guint32 a, r, g, b;
+
+			/* make the fully transparent and opaque pixels common */
+			switch (g_rand_int_range(rand, 0, 4))
+			{
+				case 0:
+				a = 0;
+				break;
+
+				case 1:
+				a = 255;
+				break;
+
+				default:
+				a = g_rand_int_range(rand, 0, 256);
+				break;
+			}
+			/* premultiplied, the components can not be bigger than
+			 * the alpha
+			 */
+			r = g_rand_int_range(rand, 0, a + 1);
+			g = g_rand_int_range(rand, 0, a + 1);
+			b = g_rand_int_range(rand, 0, a + 1);
+			row[x] = (a << 24) | (r << 16) | (g << 8) | b;
+		}
+	}
+	return s;
+}
+
+static void convert(const gchar *name, Enesim_Surface *s, GstVideoFormat fmt,
+		gboolean premultiplied, guint8 *data, gint size,
+		Eina_Rectangle *area)
+{
+	gst_egueb_converter_kernels_set(name);
+	/* the bytes outside the area must not be touched either */
+	memset(data, 0x5a, size);
+	gst_egueb_converter_surface_area(s, fmt, premultiplied, data, area);
+}
+
+static gboolean check(GRand *rand, const gchar *name, gint w, gint h)
+{
+	Enesim_Surface *s;
+	gboolean ret = TRUE;
+	guint i;
+
+	s = surface_random(rand, w, h);
+	for (i = 0; i < G_N_ELEMENTS(formats); i++)
+	{
+		GstVideoFormat fmt = formats[i];
+		guint8 *expected;
+		guint8 *result;
+		gint size;
+		gint j;
+
+		size = gst_video_format_get_size(fmt, w, h);
+		expected = g_malloc(size);
+		result = g_malloc(size);
+		/* the whole surface first, then random areas */
+		for (j = 0; j <= CHECK_AREAS * 2; j++)
+		{
+			Eina_Rectangle area;
+			Eina_Rectangle *a = NULL;
+			gboolean premultiplied = j & 1;
+
+			if (j > 1)
+			{
+				area.x = g_rand_int_range(rand, 0, w);
+				area.y = g_rand_int_range(rand, 0, h);
+				area.w = g_rand_int_range(rand, 1, w - area.x + 1);
+				area.h = g_rand_int_range(rand, 1, h - area.y + 1);
+				a = &area;
+			}
+
+			convert("c", s, fmt, premultiplied, expected, size, a);
+			convert(name, s, fmt, premultiplied, result, size, a);
+			if (memcmp(expected, result, size))
+			{
+				g_printerr("FAIL: %s format=%d %dx%d "
+						"premultiplied=%d area=%d %d %d %d\n",
+						name, fmt,
+						w, h, premultiplied,
+						a ? a->x : 0, a ? a->y : 0,
+						a ? a->w : w, a ? a->h : h);
+				ret = FALSE;
+			}
+
+			/* an area converted on top of the whole surface must
+			 * give the same pixels, the chroma included
+			 */
+			if (!a)
+				continue;
+			convert(name, s, fmt, premultiplied, expected, size,
+					NULL);
+			memcpy(result, expected, size);
+			gst_egueb_converter_surface_area(s, fmt, premultiplied,
+					result, a);
+			if (memcmp(expected, result, size))
+			{
+				g_printerr("FAIL: %s format=%d %dx%d "
+						"premultiplied=%d area=%d %d %d %d "
+						"differs from the whole surface\n",
+						name, fmt, w, h, premultiplied,
+						a->x, a->y, a->w, a->h);
+				ret = FALSE;
+			}
+		}
+		g_free(expected);
+		g_free(result);
+	}
+	enesim_surface_unref(s);
+	gst_egueb_converter_kernels_set(NULL);
+
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	GRand *rand;
+	gboolean ret = TRUE;
+	guint32 seed;
+	guint i;
+
+	gst_init(&argc, &argv);
+	enesim_init();
+
+	/* a fixed seed unless asked, to be able to reproduce a failure */
+	seed = argc > 1 ? strtoul(argv[1], NULL, 10) : 0x5eed;
+	rand = g_rand_new_with_seed(seed);
+
+	for (i = 0; i < G_N_ELEMENTS(kernels); i++)
+	{
+		gboolean passed = TRUE;
+		gint w, h;
+
+		if (!gst_egueb_converter_kernels_set(kernels[i]))
+		{
+			g_print("SKIP: %s not supported\n", kernels[i]);
+			continue;
+		}
+
+		for (h = 1; h <= CHECK_HEIGHT_MAX; h++)
+		{
+			for (w = 1; w <= CHECK_WIDTH_MAX; w++)
+			{
+				if (!check(rand, kernels[i], w, h))
+					passed = FALSE;
+			}
+		}
+		g_print("%s: %s\n", passed ? "PASS" : "FAIL", kernels[i]);
+		if (!passed)
+			ret = FALSE;
+	}
+
+	g_rand_free(rand);
+	enesim_shutdown();
+
+	return ret ? 0 : 1;
+}
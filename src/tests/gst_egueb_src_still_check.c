@@ -0,0 +1,158 @@
+/* Gst Egueb - Gstreamer based plugins and libs for Egueb
+ * Copyright (C) 2014 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Check that a document without animations negotiated at a framerate of
+ * 0/1 sends a single frame and then waits, and that an input event makes
+ * it send a new one
+ */
+#include <string.h>
+#include <gst/gst.h>
+
+#define CHECK_WAIT (500 * GST_MSECOND)
+
+static const gchar *document =
+		"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"64\" "
+		"height=\"64\"><rect width=\"32\" height=\"32\" "
+		"fill=\"red\"/></svg>";
+
+static gint buffers = 0;
+
+static void buffer_cb(GstElement *sink, GstBuffer *buffer, GstPad *pad,
+		gpointer data)
+{
+	g_atomic_int_inc(&buffers);
+}
+
+/* the errors end the check right away */
+static gboolean messages_wait(GstElement *pipeline)
+{
+	GstBus *bus;
+	GstMessage *msg;
+	gboolean ret = TRUE;
+
+	bus = gst_element_get_bus(pipeline);
+	msg = gst_bus_timed_pop_filtered(bus, CHECK_WAIT,
+			GST_MESSAGE_ERROR | GST_MESSAGE_EOS);
+	if (msg)
+	{
+		g_printerr("FAIL: unexpected %s message\n",
+				GST_MESSAGE_TYPE_NAME(msg));
+		gst_message_unref(msg);
+		ret = FALSE;
+	}
+	gst_object_unref(bus);
+
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	GstElement *pipeline;
+	GstElement *src;
+	GstElement *sink;
+	GstBuffer *xml;
+	GstCaps *caps;
+	GstPad *pad;
+	GError *err = NULL;
+	gboolean ret = FALSE;
+	gint framerate_n = -1;
+	gint framerate_d = -1;
+
+	gst_init(&argc, &argv);
+	if (!gst_plugin_load_file(GST_EGUEB_PLUGIN, &err))
+	{
+		g_printerr("FAIL: loading the plugin: %s\n", err->message);
+		g_error_free(err);
+		return 1;
+	}
+
+	pipeline = gst_parse_launch("eguebsrc name=src still-mode=still ! "
+			"video/x-raw-rgb,framerate=0/1 ! "
+			"fakesink name=sink sync=true signal-handoffs=true", &err);
+	if (!pipeline)
+	{
+		g_printerr("FAIL: creating the pipeline: %s\n", err->message);
+		g_error_free(err);
+		return 1;
+	}
+	src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+	sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+	g_signal_connect(sink, "handoff", G_CALLBACK(buffer_cb), NULL);
+
+	xml = gst_buffer_new_and_alloc(strlen(document));
+	memcpy(GST_BUFFER_DATA(xml), document, strlen(document));
+	g_object_set(src, "xml", xml, NULL);
+	gst_buffer_unref(xml);
+
+	gst_element_set_state(pipeline, GST_STATE_PLAYING);
+	gst_element_get_state(pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+	if (!messages_wait(pipeline))
+		goto done;
+
+	pad = gst_element_get_static_pad(sink, "sink");
+	caps = gst_pad_get_negotiated_caps(pad);
+	if (caps)
+	{
+		gst_structure_get_fraction(gst_caps_get_structure(caps, 0),
+				"framerate", &framerate_n, &framerate_d);
+		gst_caps_unref(caps);
+	}
+	if (framerate_n != 0 || framerate_d != 1)
+	{
+		g_printerr("FAIL: negotiated a framerate of %d/%d\n",
+				framerate_n, framerate_d);
+		gst_object_unref(pad);
+		goto done;
+	}
+
+	/* the source waits instead of pushing more frames */
+	if (g_atomic_int_get(&buffers) != 1)
+	{
+		g_printerr("FAIL: %d buffers before any input\n",
+				g_atomic_int_get(&buffers));
+		gst_object_unref(pad);
+		goto done;
+	}
+
+	/* any input wakes it up, a new frame is sent */
+	gst_pad_push_event(pad, gst_event_new_navigation(
+			gst_structure_new("application/x-gst-navigation",
+			"event", G_TYPE_STRING, "mouse-move",
+			"pointer_x", G_TYPE_DOUBLE, 8.0,
+			"pointer_y", G_TYPE_DOUBLE, 8.0,
+			NULL)));
+	gst_object_unref(pad);
+	if (!messages_wait(pipeline))
+		goto done;
+	if (g_atomic_int_get(&buffers) != 2)
+	{
+		g_printerr("FAIL: %d buffers after an input\n",
+				g_atomic_int_get(&buffers));
+		goto done;
+	}
+	ret = TRUE;
+	g_print("PASS: still\n");
+
+done:
+	gst_element_set_state(pipeline, GST_STATE_NULL);
+	gst_object_unref(src);
+	gst_object_unref(sink);
+	gst_object_unref(pipeline);
+
+	return ret ? 0 : 1;
+}